@@ -5,6 +5,8 @@
  * the local data to deduce the local factors from the conjugacy classes
  *
  * python function to generate input provided at the bottom with an example
+ *
+ * Usage: artin.exe <input file> <output file> [number of workers]
  */
 #define __STDC_FORMAT_MACROS
 #define special_values_size 2 // implies computing L(1) ... L(special_values_size)
@@ -777,40 +779,36 @@ void lpoly(const int64_t &p, artin_rep &AR) {
 int main (int argc, char**argv)
 {
   try {
-    assert_print(argc, ==, 3);
+    assert_print(argc, >=, 3);
+    // how many lines to work on at once
+    size_t n_workers = argc > 3 ? std::stoul(argv[3]) : 1;
     printf("Input: %s\n", argv[1]);
     printf("Output: %s\n", argv[2]);
 
     ifstream input(argv[1]);
     ofstream output(argv[2]);
-    string   line;
-
-    primesieve::iterator ps;
-
-    int r = 0;
-
 
-    while(std::getline(input, line)) {
+    int r = batch_run(input, output, n_workers, [](const string &line, batch_result &res) {
       SystemTime start(std::chrono::system_clock::now());
-      std::time_t startt = std::chrono::system_clock::to_time_t(start);
-      cout << "Date:   \t" <<  std::put_time(std::localtime(&startt), "%F %T") << endl;
+      string_file log;
+      fprintf(log.f, "Date:   \t%s\n", date_now().c_str());
 
       artin_rep AR;
       Lfunc_t &L = AR.L;
+      primesieve::iterator ps;
 
 
       // read a line
       stringstream linestream(line);
       linestream >> AR;
-      cout << "Starting:\t"<<AR.label<<endl;
+      fprintf(log.f, "Starting:\t%s\n", AR.label.c_str());
 
       // we need all the local factors p <= target_M
       uint64_t target_M = Lfunc_nmax(L);
 
-      cout <<"using p <= " << target_M << endl;
+      fprintf(log.f, "using p <= %" PRIu64 "\n", target_M);
 
       // populate local factors
-      ps.jump_to(0);
       for(uint64_t p = ps.next_prime(); p <= target_M; p = ps.next_prime())
         lpoly(int64_t(p), AR);
 
@@ -822,41 +820,50 @@ int main (int argc, char**argv)
         std::abort();
       }
 
-      printf("Rank = %" PRIu64 "\n",Lfunc_rank(L));
-      printf("Epsilon = ");acb_printd(Lfunc_epsilon(L),20);printf("\n");
-      printf("Leading Taylor coeff = ");arb_printd(Lfunc_Taylor(L), 20);printf("\n");
-      printf("First zero = ");arb_printd(Lfunc_zeros(L, 0), 20);printf("\n");
+      fprintf(log.f, "Rank = %" PRIu64 "\n",Lfunc_rank(L));
+      fprintf(log.f, "Epsilon = ");acb_fprintd(log.f, Lfunc_epsilon(L),20);fprintf(log.f, "\n");
+      fprintf(log.f, "Leading Taylor coeff = ");arb_fprintd(log.f, Lfunc_Taylor(L), 20);fprintf(log.f, "\n");
+      fprintf(log.f, "First zero = ");arb_fprintd(log.f, Lfunc_zeros(L, 0), 20);fprintf(log.f, "\n");
 
+      array<double, special_values_size> sv_re, sv_im;
+      array<Lerror_t, special_values_size> sv_ecodes;
       for(size_t i = 0; i < AR.special_values.size(); ++i) {
         acb_init(&AR.special_values[i]);
-        AR.ecode |= Lfunc_special_value(&AR.special_values[i], L, i + 1, 0);
-        if(fatal_error(AR.ecode)) {
-          fprint_errors(stderr, AR.ecode);
-          std::abort();
-        }
-        printf("L(%lu) = ", i + 1);acb_printd(&AR.special_values[i],20);printf("\n");
+        sv_re[i] = i + 1;
+        sv_im[i] = 0;
+      }
+      AR.ecode |= Lfunc_special_values(AR.special_values.data(), L, sv_re.data(), sv_im.data(), AR.special_values.size(), sv_ecodes.data());
+      if(fatal_error(AR.ecode)) {
+        fprint_errors(stderr, AR.ecode);
+        std::abort();
+      }
+      for(size_t i = 0; i < AR.special_values.size(); ++i) {
+        fprintf(log.f, "L(%lu) = ", i + 1);acb_fprintd(log.f, &AR.special_values[i],20);fprintf(log.f, "\n");
       }
 
-      output << AR << endl;
+      stringstream out;
+      out << AR << endl;
+      res.output = out.str();
       // print any warnings collected along the way
       // ignore could not achieve target error bound in special value
       if( AR.ecode != ERR_SUCCESS and AR.ecode != ERR_SPEC_PREC ) {
-        cerr << "Begin warnings for " << AR.label << endl;
-        fprint_errors(stderr, AR.ecode);
-        cerr << "End warnings for " << AR.label << endl;
-        r++;
+        string_file err;
+        fprintf(err.f, "Begin warnings for %s\n", AR.label.c_str());
+        fprint_errors(err.f, AR.ecode);
+        fprintf(err.f, "End warnings for %s\n", AR.label.c_str());
+        res.errors = err.str();
+        res.warnings = 1;
       }
 
       SystemTime end(std::chrono::system_clock::now());
-      std::time_t endt = std::chrono::system_clock::to_time_t(end);
       double walltime = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-      cout << "Date:   \t" <<  std::put_time(std::localtime(&endt), "%F %T") << endl;
-      cout << "Done:   \t"<< AR.label << "\ttook ";
-      cout << std::setw(6) << std::setfill(' ')  << std::fixed << std::setprecision(2) << walltime/1000 << "s"<< endl << endl;
+      fprintf(log.f, "Date:   \t%s\n", date_now().c_str());
+      fprintf(log.f, "Done:   \t%s\ttook %6.2fs\n\n", AR.label.c_str(), walltime/1000);
+      res.log = log.str();
 
       //free memory
       artin_rep_clear(AR);
-    }
+    });
     flint_cleanup();
     return r;
   } catch( const std::exception & ex ) {
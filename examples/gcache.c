@@ -0,0 +1,247 @@
+// See LICENSE file for license details.
+//
+/*
+ * Fills the G cache ahead of time so that later runs never compute G.
+ *
+ * Usage:
+ * gcache.exe [-d cache_dir] [-w workers] [-p target_prec] list <input file>
+ * gcache.exe [-d cache_dir] [-w workers] [-p target_prec] all <max degree> <max weight>
+ *
+ * list: each line of the input file is
+ *   <degree> <normalisation> <mu_1> ... <mu_degree> [<target_prec>]
+ * as for Lfunc_init, e.g. "2 0.5 0 1" for an elliptic curve over Q.
+ * all: every analytic mu vector of degree 2..<max degree> with each mu
+ *   in {0,1/2,...,<max weight>/2+1}, i.e. anything of motivic weight
+ *   up to <max weight>.
+ *
+ * -p may be given more than once to fill the cache for several
+ * precisions (default DEFAULT_TARGET_PREC). The signatures are shared
+ * out between the workers (default 1) and each one computes G using a
+ * single thread. Several copies of this program may share a cache.
+ */
+
+#include <acb_poly.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "glfunc.h"
+
+#define MAX_PRECS (16)
+
+typedef struct {
+  uint64_t degree;
+  double normalisation;
+  double mus[MAX_DEGREE];
+  int64_t target_prec;
+} signature_t;
+
+typedef struct {
+  signature_t *sigs;
+  size_t n_sigs;
+  size_t next;
+  char *cache_dir;
+  int status;
+  pthread_mutex_t lock;
+} job_list_t;
+
+static int add_signature(signature_t **sigs, size_t *n, size_t *allocated, const signature_t *s) {
+  if (*n == *allocated) {
+    size_t a = *allocated ? 2 * *allocated : 64;
+    signature_t *p = (signature_t *)realloc(*sigs, sizeof(signature_t) * a);
+    if (!p)
+      return 1;
+    *sigs = p;
+    *allocated = a;
+  }
+  (*sigs)[(*n)++] = *s;
+  return 0;
+}
+
+// read "<degree> <normalisation> <mus...> [<target_prec>]" lines,
+// one signature per line and precision (or the line's own precision)
+static int read_list(FILE *f, const int64_t *precs, size_t n_precs, signature_t **sigs, size_t *n, size_t *allocated) {
+  char *line = NULL;
+  size_t len = 0;
+  uint64_t line_no = 0;
+  int status = 0;
+  while (getline(&line, &len, f) != -1) {
+    line_no++;
+    char *p = line, *end;
+    while (*p == ' ' || *p == '\t')
+      p++;
+    if (*p == '\n' || *p == 0 || *p == '#')
+      continue;
+    signature_t s;
+    s.degree = strtoull(p, &end, 10);
+    bool ok = (end != p) && (s.degree >= 2) && (s.degree <= MAX_DEGREE);
+    p = end;
+    s.normalisation = strtod(p, &end);
+    ok = ok && (end != p);
+    p = end;
+    for (uint64_t i = 0; ok && (i < s.degree); i++) {
+      s.mus[i] = strtod(p, &end);
+      ok = (end != p);
+      p = end;
+    }
+    if (!ok) {
+      fprintf(stderr, "Bad signature on line %" PRIu64 ", skipping it.\n", line_no);
+      status = 1;
+      continue;
+    }
+    s.target_prec = strtoll(p, &end, 10);
+    if (end != p) { // this line says which precision
+      status |= add_signature(sigs, n, allocated, &s);
+      continue;
+    }
+    for (size_t j = 0; j < n_precs; j++) {
+      s.target_prec = precs[j];
+      status |= add_signature(sigs, n, allocated, &s);
+    }
+  }
+  free(line);
+  return status;
+}
+
+// every non-decreasing vector of mus in {0,1/2,...,max_mu2/2}
+static int enumerate(uint64_t degree, uint64_t max_mu2, const int64_t *precs, size_t n_precs, signature_t **sigs, size_t *n, size_t *allocated) {
+  uint64_t mu2[MAX_DEGREE];
+  for (uint64_t i = 0; i < degree; i++)
+    mu2[i] = 0;
+  while (true) {
+    signature_t s;
+    s.degree = degree;
+    s.normalisation = 0.0;
+    for (uint64_t i = 0; i < degree; i++)
+      s.mus[i] = 0.5 * mu2[i];
+    for (size_t j = 0; j < n_precs; j++) {
+      s.target_prec = precs[j];
+      if (add_signature(sigs, n, allocated, &s))
+        return 1;
+    }
+    // next vector in lexicographic order
+    uint64_t i = degree;
+    while (i > 0 && mu2[i - 1] == max_mu2)
+      i--;
+    if (i == 0)
+      return 0;
+    mu2[i - 1]++;
+    for (; i < degree; i++)
+      mu2[i] = mu2[i - 1];
+  }
+}
+
+static void *worker(void *arg) {
+  job_list_t *jobs = (job_list_t *)arg;
+  while (true) {
+    pthread_mutex_lock(&jobs->lock);
+    size_t j = jobs->next++;
+    pthread_mutex_unlock(&jobs->lock);
+    if (j >= jobs->n_sigs)
+      break;
+    signature_t *s = jobs->sigs + j;
+
+    Lparams_t Lp;
+    Lparams_init(&Lp);
+    Lp.degree = s->degree;
+    Lp.normalisation = s->normalisation;
+    Lp.mus = s->mus;
+    Lp.target_prec = s->target_prec;
+    Lp.cache_dir = jobs->cache_dir;
+    Lp.n_threads = 1; // the parallelism is across signatures
+    Lerror_t ecode = Lfunc_fill_gcache(&Lp);
+
+    pthread_mutex_lock(&jobs->lock);
+    printf("%" PRIu64 ":%.2f:[", s->degree, s->normalisation);
+    for (uint64_t i = 0; i < s->degree; i++)
+      printf(i ? ",%.1f" : "%.1f", s->mus[i]);
+    printf("]:%" PRId64 " %s\n", s->target_prec, ecode == ERR_SUCCESS ? "done" : "failed");
+    if (ecode != ERR_SUCCESS) {
+      fprint_errors(stderr, ecode);
+      jobs->status = 1;
+    }
+    fflush(stdout);
+    pthread_mutex_unlock(&jobs->lock);
+  }
+  flint_cleanup();
+  return NULL;
+}
+
+static int usage(char *name) {
+  fprintf(stderr, "Usage:\n %s [-d cache_dir] [-w workers] [-p target_prec] list <input file>\n", name);
+  fprintf(stderr, " %s [-d cache_dir] [-w workers] [-p target_prec] all <max degree> <max weight>\n", name);
+  return 1;
+}
+
+int main(int argc, char **argv) {
+  char *cache_dir = ".";
+  size_t n_workers = 1;
+  int64_t precs[MAX_PRECS];
+  size_t n_precs = 0;
+
+  int a = 1;
+  for (; a + 1 < argc && argv[a][0] == '-'; a += 2) {
+    if (!strcmp(argv[a], "-d"))
+      cache_dir = argv[a + 1];
+    else if (!strcmp(argv[a], "-w"))
+      n_workers = strtoul(argv[a + 1], NULL, 10);
+    else if (!strcmp(argv[a], "-p") && n_precs < MAX_PRECS)
+      precs[n_precs++] = strtoll(argv[a + 1], NULL, 10);
+    else
+      return usage(argv[0]);
+  }
+  if (n_precs == 0)
+    precs[n_precs++] = DEFAULT_TARGET_PREC;
+  if (n_workers < 1)
+    n_workers = 1;
+
+  signature_t *sigs = NULL;
+  size_t n_sigs = 0, allocated = 0;
+  int status;
+  if (a + 2 == argc && !strcmp(argv[a], "list")) {
+    FILE *input = fopen(argv[a + 1], "r");
+    if (input == NULL) {
+      printf("Could not open file %s.\n", argv[a + 1]);
+      return 1;
+    }
+    status = read_list(input, precs, n_precs, &sigs, &n_sigs, &allocated);
+    fclose(input);
+  } else if (a + 3 == argc && !strcmp(argv[a], "all")) {
+    uint64_t max_degree = strtoull(argv[a + 1], NULL, 10);
+    uint64_t max_weight = strtoull(argv[a + 2], NULL, 10);
+    if (max_degree > MAX_DEGREE)
+      max_degree = MAX_DEGREE;
+    status = 0;
+    for (uint64_t d = 2; d <= max_degree && !status; d++)
+      status = enumerate(d, max_weight + 2, precs, n_precs, &sigs, &n_sigs, &allocated);
+  } else
+    return usage(argv[0]);
+  printf("Filling %s with %zu G tables using %zu workers.\n", cache_dir, n_sigs, n_workers);
+
+  job_list_t jobs;
+  jobs.sigs = sigs;
+  jobs.n_sigs = n_sigs;
+  jobs.next = 0;
+  jobs.cache_dir = cache_dir;
+  jobs.status = status;
+  pthread_mutex_init(&jobs.lock, NULL);
+
+  pthread_t *tids = (pthread_t *)malloc(sizeof(pthread_t) * n_workers);
+  size_t started = 0;
+  if (tids)
+    for (; started < n_workers; started++)
+      if (pthread_create(tids + started, NULL, worker, &jobs))
+        break;
+  if (started == 0)
+    worker(&jobs); // do it ourselves
+  for (size_t t = 0; t < started; t++)
+    pthread_join(tids[t], NULL);
+
+  free(tids);
+  free(sigs);
+  pthread_mutex_destroy(&jobs.lock);
+  return jobs.status;
+}
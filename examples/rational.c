@@ -7,6 +7,7 @@
  *
  *
  * Usage:
+ * rational.exe <input file> <output file> [number of workers]
  *
  * Input file:
  * label:degree:conductor:weight:mus:euler_factors
@@ -23,6 +24,8 @@
 #include <ctype.h>
 #include <inttypes.h>
 #include <primesieve.h>
+#include <pthread.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -203,6 +206,7 @@ void populate_local_factors(Lfunc_rational_t L) {
   }
 
   acb_poly_clear(local_factor);
+  primesieve_free(primes);
 }
 
 
@@ -223,6 +227,7 @@ void Lfunc_rational_init(Lfunc_rational_t L) {
   L->L = NULL;
   L->mus = NULL;
   L->euler_factors = NULL;
+  L->ecode = ERR_SUCCESS;
 }
 
 int Lfunc_rational_set_s(Lfunc_rational_t L, char *s) {
@@ -271,10 +276,8 @@ int Lfunc_rational_set_s(Lfunc_rational_t L, char *s) {
   }
   if(status != -1) {
     L->L = Lfunc_init(L->degree, L->conductor, L->weight*0.5, L->mus, &L->ecode);
-    if(fatal_error(L->ecode)) {
-      fprint_errors(stderr, L->ecode);
-      status = -1;
-    }
+    if(fatal_error(L->ecode))
+      status = -1; // the caller reports L->ecode
   }
 
   replace_null(s, ':', tokens_length - 1);
@@ -284,10 +287,177 @@ int Lfunc_rational_set_s(Lfunc_rational_t L, char *s) {
 
 
 
+// Batch runner
+// The main thread reads lines ahead of a pool of workers into a window
+// of slots. Each worker takes the oldest line nobody has claimed yet,
+// waiting when there is none. What process writes to log for each line
+// is copied to stdout in the order of the input.
+typedef struct {
+  char *line;
+  char *log; // filled in by the worker
+  size_t log_len;
+  int status;
+  bool done;
+} batch_line_t;
+
+typedef struct {
+  int (*process)(char *line, FILE *log);
+  size_t window; // most lines read but not yet written
+  batch_line_t *lines; // line n lives in lines[n % window]
+  pthread_mutex_t lock; // protects everything below
+  pthread_cond_t work, space;
+  size_t next_in; // lines read so far
+  size_t next_claim; // the next line a worker takes
+  size_t next_out; // the next line whose log gets written
+  bool eof;
+  int status;
+} batch_t;
+
+static void *batch_worker(void *arg) {
+  batch_t *b = (batch_t *) arg;
+  while(true) {
+    pthread_mutex_lock(&b->lock);
+    while(b->next_claim == b->next_in && !b->eof)
+      pthread_cond_wait(&b->work, &b->lock);
+    if(b->next_claim == b->next_in) {
+      pthread_mutex_unlock(&b->lock);
+      break; // no more lines coming
+    }
+    batch_line_t *bl = b->lines + b->next_claim++ % b->window;
+    pthread_mutex_unlock(&b->lock);
+
+    FILE *log = open_memstream(&bl->log, &bl->log_len);
+    bl->status = log ? b->process(bl->line, log) : -1;
+    if(log)
+      fclose(log);
+
+    pthread_mutex_lock(&b->lock);
+    bl->done = true;
+    for(bl = b->lines + b->next_out % b->window; bl->done; bl = b->lines + b->next_out % b->window) {
+      if(bl->log)
+        fwrite(bl->log, 1, bl->log_len, stdout);
+      if(bl->status)
+        b->status = -1;
+      free(bl->line);
+      free(bl->log);
+      bl->done = false;
+      b->next_out++;
+    }
+    fflush(stdout);
+    pthread_cond_signal(&b->space);
+    pthread_mutex_unlock(&b->lock);
+  }
+  flint_cleanup(); // release this thread's cached constants
+  return NULL;
+}
+
+// call process(line, log) for every line of input using n_workers threads.
+// returns -1 if process failed on any line, 0 otherwise.
+int batch_run(FILE *input, size_t n_workers, int (*process)(char *line, FILE *log)) {
+  batch_t b;
+  if(n_workers < 1)
+    n_workers = 1;
+  b.process = process;
+  b.window = 4*n_workers;
+  b.lines = (batch_line_t *) calloc(b.window, sizeof(batch_line_t));
+  pthread_t *threads = (pthread_t *) malloc(n_workers*sizeof(pthread_t));
+  if(!b.lines || !threads) {
+    fprintf(stderr, "Out of memory in batch_run.\n");
+    exit(1);
+  }
+  pthread_mutex_init(&b.lock, NULL);
+  pthread_cond_init(&b.work, NULL);
+  pthread_cond_init(&b.space, NULL);
+  b.next_in = 0;
+  b.next_claim = 0;
+  b.next_out = 0;
+  b.eof = false;
+  b.status = 0;
+
+  for(size_t w = 0; w < n_workers; ++w)
+    if(pthread_create(threads + w, NULL, batch_worker, &b)) {
+      fprintf(stderr, "Could not start worker thread.\n");
+      exit(1);
+    }
+
+  while(true) {
+    char *line = NULL;
+    size_t len = 0;
+    if(getline(&line, &len, input) == -1) {
+      free(line);
+      break;
+    }
+    pthread_mutex_lock(&b.lock);
+    while(b.next_in - b.next_out >= b.window)
+      pthread_cond_wait(&b.space, &b.lock);
+    b.lines[b.next_in % b.window].line = line;
+    b.lines[b.next_in % b.window].log = NULL;
+    b.next_in++;
+    pthread_cond_signal(&b.work);
+    pthread_mutex_unlock(&b.lock);
+  }
+  pthread_mutex_lock(&b.lock);
+  b.eof = true;
+  pthread_cond_broadcast(&b.work);
+  pthread_mutex_unlock(&b.lock);
+  for(size_t w = 0; w < n_workers; ++w)
+    pthread_join(threads[w], NULL);
+
+  pthread_mutex_destroy(&b.lock);
+  pthread_cond_destroy(&b.work);
+  pthread_cond_destroy(&b.space);
+  free(b.lines);
+  free(threads);
+  return b.status;
+}
+
+
+// do one line of the input file
+int process_line(char *line, FILE *log) {
+  Lfunc_rational_t L;
+  Lfunc_rational_init(L);
+  if(Lfunc_rational_set_s(L, line) == -1) {
+    fprintf(log, "Could not parse %s", line);
+    if(fatal_error(L->ecode))
+      fprint_errors(log, L->ecode);
+    Lfunc_rational_clear(L);
+    return -1;
+  }
+  fprintf(log, "label = %s\n", L->label);
+  fprintf(log, "degree = %d conductor = %" PRId64 " weight = %d mus = [ ", L->degree, L->conductor, L->weight);
+  for(int i=0; i < L->degree; ++i)
+    fprintf(log, "%.2f ", L->mus[i]);
+  fprintf(log, "]\n");
+
+
+  populate_local_factors(L);
+  if(fatal_error(L->ecode)) {
+    fprint_errors(log, L->ecode);
+    Lfunc_rational_clear(L);
+    return -1;
+  }
+  L->ecode|=Lfunc_compute(L->L);
+  if(fatal_error(L->ecode)) {
+    fprint_errors(log, L->ecode);
+    Lfunc_rational_clear(L);
+    return -1;
+  }
+  fprintf(log, "Rank = %" PRIu64 "\n", Lfunc_rank(L->L));
+  fprintf(log, "Epsilon = ");acb_fprintd(log, Lfunc_epsilon(L->L),20);fprintf(log, "\n");
+  fprintf(log, "Leading Taylor coeff = ");arb_fprintd(log, Lfunc_Taylor(L->L), 20);fprintf(log, "\n");
+  fprintf(log, "First zero = ");arb_fprintd(log, Lfunc_zeros(L->L, 0), 20);fprintf(log, "\n");
+
+  // TODO write output to output
+  Lfunc_rational_clear(L);
+  return 0;
+}
+
+
 int main(int argc, char** argv) {
-  assert(argc == 3);
+  assert(argc == 3 || argc == 4);
   printf("Input: %s\n", argv[1]);
   printf("Output: %s\n", argv[2]);
+  size_t n_workers = argc == 4 ? strtoul(argv[3], NULL, 10) : 1;
 
   FILE* input = fopen(argv[1], "r");
   if (input == NULL) {
@@ -300,38 +470,9 @@ int main(int argc, char** argv) {
     return 1;
   }
 
-
-  char *line = NULL;
-  size_t len = 0;
-  while (getline(&line, &len, input) != -1) {
-    Lfunc_rational_t L;
-    Lfunc_rational_init(L);
-    Lfunc_rational_set_s(L, line);
-    printf("label = %s\n", L->label);
-    printf("degree = %d conductor = %" PRId64 " weight = %d mus = [ ", L->degree, L->conductor, L->weight);
-    for(int i=0; i < L->degree; ++i)
-      printf("%.2f ", L->mus[i]);
-    printf("]\n");
-
-
-    populate_local_factors(L);
-    if(fatal_error(L->ecode)) {
-      fprint_errors(stderr, L->ecode);
-      return -1;
-    }
-    L->ecode|=Lfunc_compute(L->L);
-    if(fatal_error(L->ecode)) {
-      fprint_errors(stderr, L->ecode);
-      return -1;
-    }
-    printf("Rank = %" PRIu64 "\n", Lfunc_rank(L->L));
-    printf("Epsilon = ");acb_printd(Lfunc_epsilon(L->L),20);printf("\n");
-    printf("Leading Taylor coeff = ");arb_printd(Lfunc_Taylor(L->L), 20);printf("\n");
-    printf("First zero = ");arb_printd(Lfunc_zeros(L->L, 0), 20);printf("\n");
-
-    // TODO write output to output
-    Lfunc_rational_clear(L);
-  }
+  int status = batch_run(input, n_workers, process_line);
   fclose(input);
   fclose(output);
+  flint_cleanup();
+  return status;
 }
@@ -6,6 +6,7 @@
  *
  *
  * Usage:
+ * smalljac.exe <input file> <output file> [number of workers]
  *
  * Input file:
  * label:cond:curve_str:bad_euler_factors
@@ -53,6 +54,7 @@ int main() {
 #include <iostream>
 #include <fstream>
 #include <map>
+#include <mutex>
 #include <set>
 #include <sstream>
 #include <string>
@@ -71,7 +73,6 @@ int main() {
 #include <smalljac.h>
 
 #include "glfunc.h"
-#include "glfunc_internals.h" // so we can set self-dual = yes
 #include "tracehash.h"
 #include "examples_tools.h"
 
@@ -141,6 +142,24 @@ typedef struct {
   int degree;
 } curve;
 
+// curves with the same mus share the expensive parts of their Lfuncs,
+// keyed by the mus followed by the normalisation
+static std::mutex families_lock;
+static map<vector<double>, Lfamily_t> families;
+
+Lfamily_t family_for(int degree, double normalisation, const double *mus, Lerror_t *ecode) {
+  vector<double> key(mus, mus + degree);
+  key.push_back(normalisation);
+  std::lock_guard<std::mutex> lock(families_lock);
+  auto it = families.find(key);
+  if( it != families.end() )
+    return it->second;
+  Lfamily_t F = Lfamily_init(degree, normalisation, mus, ecode);
+  if( F )
+    families[key] = F;
+  return F;
+}
+
 istream &operator>>(istream &is, curve &o)
 {
   // initialize ap
@@ -236,8 +255,14 @@ istream &operator>>(istream &is, curve &o)
         }
 
 
-        o.L = Lfunc_init(o.degree, uint64_t(o.conductor), o.symdegree * 0.5, o.mus, &o.ecode);
-        ((Lfunc *) o.L)->self_dual = YES;
+        {
+          Lfamily_t F = family_for(o.degree, o.symdegree * 0.5, o.mus, &o.ecode);
+          if( !F ) {
+            fprint_errors(stderr, o.ecode);
+            std::abort();
+          }
+          o.L = Lfunc_init_from_family(F, uint64_t(o.conductor), YES, DK, &o.ecode);
+        }
         break;
       case 4:
         if(!(ss >> o.bad_factors))
@@ -282,15 +307,23 @@ int smalljac_callback(
     void *arg){  				// forwarded arg from caller
 
   curve *C = (curve *)arg;
-  static acb_poly_t local_factor;
-  static fmpz_polyxx local_factor_zz;
-  static bool init = false;
+  // one each per worker thread, cleared when the thread exits
+  struct local_acb_poly {
+    acb_poly_t poly;
+    local_acb_poly() {
+      acb_poly_init(poly);
+      acb_poly_fit_length(poly, MAX_DEGREE + 1);
+    }
+    ~local_acb_poly() { acb_poly_clear(poly); }
+  };
+  static thread_local local_acb_poly local;
+  static thread_local fmpz_polyxx local_factor_zz;
+  static thread_local bool init = false;
   if(!init) {
-    acb_poly_init(local_factor);
     local_factor_zz.fit_length(MAX_DEGREE + 1);
-    acb_poly_fit_length(local_factor, MAX_DEGREE + 1);
     init = true;
   }
+  acb_poly_struct *local_factor = local.poly;
   local_factor_zz = 0;
   if( good ) {
     local_factor_zz.set_coeff(0, 1);
@@ -366,7 +399,6 @@ int smalljac_callback(
       C->second_moment += pow(local_factor_zz.coeff(1).to<double>(), 2)/pow(double(q), C->symdegree);
     }
   }
-  //acb_poly_clear(local_factor);
   return true;
 }
 
@@ -464,20 +496,19 @@ int main (int argc, char**argv) {
   assert_print(primes[APHASH_MAXPI-1], ==, 8191);
 
   try {
-    assert_print(argc, ==, 3);
+    assert_print(argc, >=, 3);
+    // how many lines to work on at once
+    size_t n_workers = argc > 3 ? std::stoul(argv[3]) : 1;
     printf("Input: %s\n", argv[1]);
     printf("Output: %s\n", argv[2]);
 
     ifstream input(argv[1]);
     ofstream output(argv[2]);
-    string   line;
 
-    int r = 0;
-
-    while(std::getline(input, line)) {
+    int r = batch_run(input, output, n_workers, [](const string &line, batch_result &res) {
       SystemTime start(std::chrono::system_clock::now());
-      std::time_t startt = std::chrono::system_clock::to_time_t(start);
-      cout << "Date:   \t" <<  std::put_time(std::localtime(&startt), "%F %T") << endl;
+      string_file log;
+      fprintf(log.f, "Date:   \t%s\n", date_now().c_str());
 
       curve C;
       Lerror_t &ecode = C.ecode;
@@ -487,12 +518,12 @@ int main (int argc, char**argv) {
       // read a line
       stringstream linestream(line);
       linestream >> C;
-      cout << "Starting:\t"<<C.label<<endl;
+      fprintf(log.f, "Starting:\t%s\n", C.label.c_str());
 
       // we need all the local factors p <= target_M
       uint64_t target_M = Lfunc_nmax(L);
 
-      cout <<"\tusing p <= " << target_M << endl;
+      fprintf(log.f, "\tusing p <= %" PRIu64 "\n", target_M);
 
       // populate local factors
       populate_local_factors(C);
@@ -505,22 +536,27 @@ int main (int argc, char**argv) {
       }
 
       // we use printn to match SAGE's _repr_
-      printf("\tRank = %" PRIu64 "\n",Lfunc_rank(L));
-      printf("\tEpsilon = ");acb_printn(Lfunc_epsilon(L) ,20, 0);printf("\n");
-      printf("\tFirst non-zero Taylor coeff = ");arb_printn(Lfunc_Taylor(L), 20, 0);printf("\n");
-      printf("\tFirst zero = ");arb_printn(Lfunc_zeros(L, 0), 20, 0);printf("\n");
+      fprintf(log.f, "\tRank = %" PRIu64 "\n",Lfunc_rank(L));
+      fprintf(log.f, "\tEpsilon = ");acb_fprintn(log.f, Lfunc_epsilon(L) ,20, 0);fprintf(log.f, "\n");
+      fprintf(log.f, "\tFirst non-zero Taylor coeff = ");arb_fprintn(log.f, Lfunc_Taylor(L), 20, 0);fprintf(log.f, "\n");
+      fprintf(log.f, "\tFirst zero = ");arb_fprintn(log.f, Lfunc_zeros(L, 0), 20, 0);fprintf(log.f, "\n");
 
 
       double shift = C.symdegree*0.5;
+      array<double, special_values_size> sv_re, sv_im;
+      array<Lerror_t, special_values_size> sv_ecodes;
       for(size_t i = 0; i < C.special_values.size(); ++i) {
         acb_init(&C.special_values[i]);
-        double val = 1 + i + shift;
-        ecode |= Lfunc_special_value(&C.special_values[i], L, val, 0);
-        if(fatal_error(ecode)) {
-          fprint_errors(stderr,ecode);
-          std::abort();
-        }
-        printf("\tL(%.2f) = ", val);acb_printn(&C.special_values[i],20, 0);printf("\n");
+        sv_re[i] = 1 + i + shift;
+        sv_im[i] = 0;
+      }
+      ecode |= Lfunc_special_values(C.special_values.data(), L, sv_re.data(), sv_im.data(), C.special_values.size(), sv_ecodes.data());
+      if(fatal_error(ecode)) {
+        fprint_errors(stderr,ecode);
+        std::abort();
+      }
+      for(size_t i = 0; i < C.special_values.size(); ++i) {
+        fprintf(log.f, "\tL(%.2f) = ", sv_re[i]);acb_fprintn(log.f, &C.special_values[i],20, 0);fprintf(log.f, "\n");
       }
       //printf("\tFirst 20 zeros\n");
       //arb_srcptr zeros=Lfunc_zeros(L, 0);
@@ -531,26 +567,31 @@ int main (int argc, char**argv) {
       //}
 
 
-      output << C << endl;
+      stringstream out;
+      out << C << endl;
+      res.output = out.str();
       // print any warnings collected along the way
       // ignore could not achieve target error bound in special value
       if( ecode != ERR_SUCCESS and ecode != ERR_SPEC_PREC ) {
-        cerr << "\tBegin warnings for " << C.label << endl;
-        fprint_errors(stderr, ecode);
-        cerr << "\tEnd warnings for " << C.label << endl;
-        r++;
+        string_file err;
+        fprintf(err.f, "\tBegin warnings for %s\n", C.label.c_str());
+        fprint_errors(err.f, ecode);
+        fprintf(err.f, "\tEnd warnings for %s\n", C.label.c_str());
+        res.errors = err.str();
+        res.warnings = 1;
       }
 
       SystemTime end(std::chrono::system_clock::now());
-      std::time_t endt = std::chrono::system_clock::to_time_t(end);
       double walltime = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-      cout << "Done:   \t"<< C.label << "\ttook ";
-      cout << std::setw(6) << std::setfill(' ')  << std::fixed << std::setprecision(2) << walltime/1000 << "s"<< endl;
-      cout << "Date:   \t" <<  std::put_time(std::localtime(&endt), "%F %T") << endl << endl;
+      fprintf(log.f, "Done:   \t%s\ttook %6.2fs\n", C.label.c_str(), walltime/1000);
+      fprintf(log.f, "Date:   \t%s\n\n", date_now().c_str());
+      res.log = log.str();
 
       //free memory
       curve_clear(C);
-    }
+    });
+    for(auto &elt: families)
+      Lfamily_clear(elt.second);
     flint_cleanup();
     return r;
   } catch( const std::exception & ex ) {
@@ -566,12 +607,12 @@ void sympow_ECQ(fmpz_polyxx& L, const int &symdegree) {
   assert_print(symdegree, <=, 8);
   assert_print(L.degree(), ==, 2);
   assert_print(L.get_coeff(0).is_one(), ==, true);
-  static array<fmpzxx, 21> a;
-  static array<fmpzxx, 37> p;
+  static thread_local array<fmpzxx, 21> a;
+  static thread_local array<fmpzxx, 37> p;
   const array<int, 7> maxapower = {2, 4, 6, 9, 12, 16, 20};
   const array<int, 7> maxppower = {3, 6, 10, 15, 21, 28, 36};
 
-  static bool init = false;
+  static thread_local bool init = false;
   if(!init) {
     init = true;
     for(auto &elt: a)
@@ -726,8 +767,8 @@ out += r"""
 assert_print(symdegree, <=, {max_symdeg});
 assert_print(L.degree(), ==, 2);
 assert_print(L.get_coeff(0).is_one(), ==, true);
-static std::array<fmpzxx, {maxa1}> a;
-static std::array<fmpzxx, {maxp1}> p;
+static thread_local std::array<fmpzxx, {maxa1}> a;
+static thread_local std::array<fmpzxx, {maxp1}> p;
 const std::array<int, {length}> maxapower = {maxapower};
 const std::array<int, {length}> maxppower = {maxppower};
 """.format(max_symdeg=max_symdeg,
@@ -738,7 +779,7 @@ const std::array<int, {length}> maxppower = {maxppower};
            length = len(maxapower)
           );
 out += r"""
-static bool init = false;
+static thread_local bool init = false;
 if(!init) {
   init = true;
   for(auto &elt: a)
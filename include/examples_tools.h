@@ -8,15 +8,21 @@
 #define __STDC_FORMAT_MACROS
 #include <array>
 #include <cassert>
+#include <condition_variable>
 #include <cstdint>
+#include <cstdio>
+#include <ctime>
 #include <cwctype>
+#include <deque>
 #include <iomanip>
 #include <iostream>
 #include <fstream>
 #include <map>
+#include <mutex>
 #include <set>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 #include <flint/fmpz.h>
 #include <flint/fmpzxx.h>
@@ -589,3 +595,143 @@ istream & operator>>(istream&s,  fmpz_polyxx& f){
   return s;
 }
 
+
+
+/******************************************************************************
+ * Batch runner
+ *  - string_file: a FILE* whose contents end up in a string
+ *  - date_now: the local time as a string
+ *  - batch_result: what processing one input line produced
+ *  - batch_run: process the lines of a file on a pool of workers
+ *****************************************************************************/
+
+// a FILE* that writes to memory, so that the C printing functions
+// (acb_fprintd, fprint_errors, ...) can be used by a worker without
+// its output getting mixed up with that of the others
+class string_file {
+  char *buf = nullptr;
+  size_t len = 0;
+public:
+  FILE *f;
+  string_file() : f(open_memstream(&buf, &len)) {
+    if(f == nullptr)
+      throw_line("open_memstream failed"s);
+  }
+  ~string_file() {
+    fclose(f);
+    free(buf);
+  }
+  string_file(const string_file &) = delete;
+  string_file & operator=(const string_file &) = delete;
+  string str() {
+    fflush(f);
+    return string(buf, len);
+  }
+};
+
+// the local time as YYYY-MM-DD HH:MM:SS (localtime isn't thread safe)
+inline string date_now() {
+  std::time_t t = std::time(nullptr);
+  std::tm tm;
+  localtime_r(&t, &tm);
+  char buf[32];
+  std::strftime(buf, sizeof(buf), "%F %T", &tm);
+  return buf;
+}
+
+// what processing one input line produced
+struct batch_result {
+  string output; // for the output file
+  string log; // for stdout
+  string errors; // for stderr
+  int warnings = 0; // summed up by batch_run
+};
+
+// Call process(line, result) for every line of input using n_workers
+// threads, each of which should set up its own Lfunc_t. The caller reads
+// ahead of the workers, dealing the lines out in turn to a deque per
+// worker, and a worker whose deque is empty takes from the others.
+// Idle workers sleep until the reader has queued a line for them. The
+// results are written out in the order of the input. Returns the total
+// of the warnings.
+template<class F>
+int batch_run(istream &input, ostream &output, size_t n_workers, F process) {
+  if(n_workers < 1)
+    n_workers = 1;
+  std::mutex lock; // protects everything below
+  std::condition_variable work_cv, space_cv;
+  vector<std::deque<pair<size_t, string>>> deques(n_workers);
+  size_t pending = 0; // lines queued but not yet claimed by a worker
+  bool eof = false;
+  size_t next_out = 0; // the next line whose result gets written
+  map<size_t, batch_result> done; // results waiting on earlier lines
+  int warnings = 0;
+  const size_t max_ahead = 4*n_workers; // lines read but not yet written
+
+  auto worker = [&](size_t w) {
+    while(true) {
+      pair<size_t, string> job;
+      {
+        std::unique_lock<std::mutex> g(lock);
+        work_cv.wait(g, [&]{ return pending > 0 or eof; });
+        if(pending == 0)
+          break; // no more lines coming
+        pending--;
+        // one of the queued lines is ours, own deque first
+        for(size_t i = 0; i < n_workers; ++i) {
+          std::deque<pair<size_t, string>> &d = deques[(w + i) % n_workers];
+          if(not d.empty()) {
+            job = std::move(d.front());
+            d.pop_front();
+            break;
+          }
+        }
+      }
+
+      batch_result res;
+      try {
+        process(job.second, res);
+      } catch( const std::exception & ex ) {
+        cerr << "Uncaught exception: " <<ex.what() << endl;
+        std::abort();
+      }
+
+      std::lock_guard<std::mutex> g(lock);
+      done.emplace(job.first, std::move(res));
+      for(auto it = done.begin(); it != done.end() and it->first == next_out; it = done.erase(it)) {
+        output << it->second.output;
+        cout << it->second.log;
+        cerr << it->second.errors;
+        warnings += it->second.warnings;
+        next_out++;
+      }
+      output.flush();
+      cout.flush();
+      space_cv.notify_one();
+    }
+    flint_cleanup(); // release this thread's cached constants
+  };
+
+  vector<std::thread> threads;
+  for(size_t w = 0; w < n_workers; ++w)
+    threads.emplace_back(worker, w);
+
+  string line;
+  for(size_t n = 0; std::getline(input, line); ++n) {
+    {
+      std::unique_lock<std::mutex> g(lock);
+      space_cv.wait(g, [&]{ return n - next_out < max_ahead; });
+      deques[n % n_workers].emplace_back(n, std::move(line));
+      pending++;
+    }
+    work_cv.notify_one();
+  }
+  {
+    std::lock_guard<std::mutex> g(lock);
+    eof = true;
+  }
+  work_cv.notify_all();
+  for(auto &t: threads)
+    t.join();
+  return warnings;
+}
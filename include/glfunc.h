@@ -51,7 +51,11 @@ extern "C"{
 
   // keep details under wraps
   typedef void *Lfunc_t;
+  // the parts of an Lfunc that only depend on degree, mus and precision
+  typedef void *Lfamily_t;
 
+  // fill one in with Lparams_init before setting the fields you want,
+  // so any added later keep their defaults
   typedef struct{
     uint64_t degree;
     uint64_t conductor;
@@ -63,6 +67,9 @@ extern "C"{
     int self_dual; // -1 = DK, 0 = No, 1 = Yes
     int rank; // -1 = DK
     char *cache_dir;
+    uint64_t n_threads; // most threads to use, 0 = default
+    int pin_threads; // 1 = pin workers to CPUs, -1 = don't, 0 = default
+    uint64_t first_cpu; // where pinned workers start, used if pin_threads = 1
   } Lparams_t;
 
   typedef struct{
@@ -94,9 +101,36 @@ extern "C"{
    *        mus = [6, 5] and normalisation = 0
    */
   Lfunc_t Lfunc_init(uint64_t degree, uint64_t conductor, double normalisation, const double *mus, Lerror_t *ecode);
+  // set every field of Lparams to its default, i.e. what Lfunc_init
+  // uses. degree, conductor and mus still have to be set.
+  void Lparams_init(Lparams_t *Lparams);
   // do the same but with more control
   Lfunc_t Lfunc_init_advanced(Lparams_t *Lparams, Lerror_t *ecode);
 
+  // L-functions with the same degree, mus (after normalisation) and
+  // precision share their G tables, FFT twiddles and so on. Set these up
+  // once as a family and then each Lfunc in it costs very little.
+  // the conductor, self_dual and rank in Lparams are ignored.
+  Lfamily_t Lfamily_init(uint64_t degree, double normalisation, const double *mus, Lerror_t *ecode);
+  Lfamily_t Lfamily_init_advanced(Lparams_t *Lparams, Lerror_t *ecode);
+  // an Lfunc in family F. Several threads may do this with the same F
+  // at once. F must not be cleared before every Lfunc made from it is.
+  Lfunc_t Lfunc_init_from_family(Lfamily_t F, uint64_t conductor, int self_dual, int rank, Lerror_t *ecode);
+  // reclaim memory from an Lfamily_t structure
+  void Lfamily_clear(Lfamily_t F);
+
+  // make sure the G cache in Lp->cache_dir holds the table an Lfunc made
+  // from Lp would use, computing it if need be. Nothing else is set up.
+  // the conductor, self_dual and rank in Lp are ignored.
+  Lerror_t Lfunc_fill_gcache(Lparams_t *Lparams);
+
+  // set the threading used by Lfuncs initialised from now on when their
+  // Lparams_t leave it at 0. n_threads = 0 restores the built in default.
+  // pin_threads is as in Lparams_t and 0 means don't. If pinned, worker
+  // t runs on the (first_cpu+t)th CPU, mod the number of CPUs the
+  // process may use. The calling thread is never pinned.
+  void Lfunc_set_threads(uint64_t n_threads, int pin_threads, uint64_t first_cpu);
+
   // for a given conductor, what is the max_p for which an Euler poly
   // will be expected.
   uint64_t Lfunc_nmax(Lfunc_t L);
@@ -108,6 +142,12 @@ extern "C"{
   // it will stop calling if poly is set to zero and reset nmax accordingly
   Lerror_t Lfunc_use_all_lpolys(Lfunc_t L, void (*lpoly_callback) (acb_poly_t lpoly, uint64_t p, int d, int64_t prec, void *parm), void *param);
 
+  // as above, but lpoly_callback is called from several threads at once
+  // and possibly for primes beyond the one where it first sets poly to
+  // zero, so it must be thread safe. The coefficients are identical to
+  // those from Lfunc_use_all_lpolys.
+  Lerror_t Lfunc_use_all_lpolys_parallel(Lfunc_t L, void (*lpoly_callback) (acb_poly_t lpoly, uint64_t p, int d, int64_t prec, void *parm), void *param);
+
   // you provide one Euler polynomial at a time
   void Lfunc_use_lpoly(Lfunc_t L, uint64_t p, const acb_poly_t poly);
 
@@ -153,6 +193,12 @@ extern "C"{
   // for re+i*im = (w + 1)/2, use Lfunc_Taylor
   Lerror_t Lfunc_special_value(acb_t res, Lfunc_t LL, double re, double im);
 
+  // compute L(re[i]+i*im[i]) into res+i for i=0..n-1, sharing the
+  // search for upsampling parameters between points with the same re
+  // and evaluating the points in parallel. ecodes[i] gets the error
+  // code for point i and the union of them all is returned.
+  Lerror_t Lfunc_special_values(acb_ptr res, Lfunc_t LL, const double *re, const double *im, uint64_t n, Lerror_t *ecodes);
+
   // reclaim memory from an Lfunc_t structure
   void Lfunc_clear(Lfunc_t L);
 
@@ -14,12 +14,30 @@
 
 #define MAX_L (10) // maximum differential allowed in upsampling
 
+#define G_BLOCK (256) // rows of G computed and packed at a time
+
+// largest wprec for which the final iFFT is done in double-double
+// (dd_fft.c). 0 means never.
+#ifndef DD_MAX_PREC
+#define DD_MAX_PREC (100)
+#endif
+
+// worker threads used by the parallel stages
+#ifndef DEFAULT_N_THREADS
+#define DEFAULT_N_THREADS (1)
+#endif
+
 
 #define COMPUTE_ZEROS
 #define COMPUTE_RANK
+// define FIXED_CONVOLVE (./configure --enable-fixed-convolve) to
+// convolve by exact integer products (fixed_convolve.c) rather than
+// ball FFTs. make check-fixed runs the tests that way.
 
 #include <acb.h>
+#include <flint/fmpz_poly.h>
 #include <inttypes.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include "glfunc.h"
 
@@ -27,7 +45,63 @@
 extern "C"{
 #endif
 
+  // how a parallel stage may use threads
   typedef struct{
+    uint64_t n_threads; // most threads to use, including the caller
+    int64_t first_cpu; // pin worker t to allowed CPU first_cpu+t, -1 = don't pin
+  } Lthreads_t;
+
+  // one G_k(i) in a gseg_t
+  typedef struct{
+    uint32_t off; // its limbs start at limbs[off]
+    int32_t dexp; // its mid has exponent exp[k]-dexp
+    uint16_t n_used; // limbs of mid, 0 if mid is zero
+    uint16_t sign;
+  } gent_t;
+
+  // rows lo..hi of G held in memory. Only absolute precision matters
+  // to the convolutions, so each G_k(i) keeps just the leading bits of
+  // its mid down to 2^(exp[k]-gprec), exp[k] being the largest exponent
+  // of G_k around it, and all the G_k in the run share radius rad[k].
+  typedef struct{
+    int64_t lo,hi;
+    slong *exp; // max_K of them
+    mag_struct *rad; // ditto
+    gent_t *ents; // G_k(i) in ents[(i-lo)*max_K+k]
+    mp_limb_t *limbs;
+  } gseg_t;
+
+  // a vector scaled to integers, see fixed_convolve.c
+  typedef struct{
+    fmpz_poly_t re,im;
+    slong exp;
+    bool real; // im is exactly zero
+    mag_t rad; // bounds the error in every re and im
+    mag_t sum_re,sum_im; // of |re| and |im|, scaled back
+  } fixed_vec_t;
+
+  // an exact sum of folded integer convolutions, re[m]*2^exp etc.
+  typedef struct{
+    fmpz *re,*im;
+    uint64_t n;
+    slong exp; // means nothing while all of re and im are zero
+    bool zero; // so far every re and im is zero
+    mag_t err_re,err_im; // bound the error in every re and im
+  } fixed_sum_t;
+
+  // the G_k ready to convolve with, built from rows lo..hi_i and shared
+  // by an Lfunc family (see get_Ghat)
+  typedef struct Ghat_struct{
+    int64_t lo;
+    uint64_t users; // Lfuncs convolving with these right now
+    acb_t **G; // G_k transformed in G[k]
+    fixed_vec_t *Gf; // or, with FIXED_CONVOLVE, G_k as integers in Gf[k]
+    struct Ghat_struct *next; // the family's other sets, newest first
+  } Ghat_t;
+
+  typedef struct Lfunc_struct{
+    struct Lfunc_struct *family; // whose read only parts we share, if any
+    bool owns_family; // clear family along with us
     uint64_t degree;
     uint64_t conductor;
     double normalisation;
@@ -38,6 +112,7 @@ extern "C"{
     int64_t wprec; // working precision
     int64_t gprec; // precison used by g
     char *cache_dir;
+    Lthreads_t threads; // what the parallel stages may use
     int self_dual;
     int rank;
     arb_t mu;
@@ -56,7 +131,15 @@ extern "C"{
     uint64_t max_K;
     arb_t eq59;
 
-    arb_t **Gs;
+    gseg_t **Gs; // row low_i+j is in Gs[j], for rows not in gmap
+    const uint8_t *gmap; // a binary G cache file mapped read only
+    size_t gmap_size;
+    const uint8_t *grecs; // the G records within gmap
+    size_t grec_size;
+    int64_t gmap_lo; // lowest row in gmap
+    int64_t g_lo; // lowest row we hold, rows below are filled in by need_G
+    char *gname; // the cache file to keep up to date, if any
+    pthread_mutex_t g_lock; // held while need_G fills in rows
 
     // computation related
     uint64_t fft_N;
@@ -66,14 +149,14 @@ extern "C"{
     arf_t arf_A;
     arb_t one_over_A;
     arf_t arf_one_over_A;
-    acb_t *G;
+    Ghat_t *Ghat; // the family's G_k transforms, one set per lo
     acb_t *w; // twiddle factors for length fft_N
     acb_t *ww; // ditto for fft_NN
     arb_t *zeros[2];
     double eta;
     arb_t delta;
     arb_t exp_delta;
-    acb_t *kres,*res,**skm;
+    acb_t *res,**skm;
     arb_t pre_ftwiddle_error;
     arb_t ftwiddle_error;
 
@@ -123,14 +206,47 @@ extern "C"{
 
   // from glfunc_g.c
   Lerror_t compute_g(Lfunc *);
+  Lerror_t extend_G(Lfunc *L, int64_t lo);
+  Lerror_t need_G(Lfunc *L, int64_t lo);
+
+  // from gcache.c
+  arb_srcptr get_G(arb_struct *view, Lfunc *L, uint64_t k, int64_t j);
+  bool alloc_Gs(Lfunc *L);
+  bool add_G_rows(Lfunc *L, int64_t lo, int64_t hi, arb_srcptr g, slong *exps);
+  void drop_G_rows(Lfunc *L, int64_t lo, int64_t hi);
+  void clear_Gs(Lfunc *L);
+  bool write_gfile_bin(FILE *outfile, Lfunc *L);
+  int read_gfile_bin(FILE *infile, Lfunc *L, int64_t lo);
+  bool use_gmap_rows(Lfunc *L, int64_t lo);
+  int map_gfile_bin(const char *fname, Lfunc *L);
+  bool find_gfile_bin(char *fname, size_t len, const char *dir, const char *key, int64_t prec);
 
   // from acb_fft.c
-  void acb_initfft(acb_t *w, uint64_t n, uint64_t prec);
-  void acb_fft(acb_t *x, uint64_t n, acb_t *w, uint64_t prec);
-  void acb_ifft(acb_t *x, uint64_t n, acb_t *w, uint64_t prec);
-  void acb_convolve(acb_t *res, acb_t *x, acb_t *y, uint64_t n, acb_t *w, uint64_t prec);
-  void acb_convolve1(acb_t *res, acb_t *x, acb_t *y, uint64_t n, acb_t *w, uint64_t prec);
-  void acb_convolve2(acb_t *res, acb_t *x, acb_t *y, uint64_t n, acb_t *w, uint64_t prec);
+  // th says how many threads the transform may use
+  void acb_initfft(acb_t *w, uint64_t n, int64_t prec);
+  acb_t *get_twiddles(uint64_t n, int64_t prec);
+  void release_twiddles(acb_t *w);
+  void acb_fft(acb_t *x, uint64_t n, acb_t *w, int64_t prec, const Lthreads_t *th);
+  void acb_ifft(acb_t *x, uint64_t n, acb_t *w, int64_t prec, const Lthreads_t *th);
+  void acb_convolve(acb_t *res, acb_t *x, acb_t *y, uint64_t n, acb_t *w, int64_t prec, const Lthreads_t *th);
+  void acb_convolve1(acb_t *res, acb_t *x, acb_t *y, uint64_t n, acb_t *w, int64_t prec, const Lthreads_t *th);
+  void acb_convolve2(acb_t *res, acb_t *x, acb_t *y, uint64_t n, acb_t *w, int64_t prec, const Lthreads_t *th);
+  void acb_fft_real2(acb_t *x, acb_t *y, uint64_t n, acb_t *w, int64_t prec, const Lthreads_t *th);
+  bool acb_ifft_pruned(acb_t *res, acb_t *x, uint64_t m, uint64_t n, uint64_t a, acb_t *w, acb_t *ww, int64_t prec, bool dd, const Lthreads_t *th);
+  bool acb_ifft_hermitian(acb_t *x, uint64_t m, uint64_t nn, uint64_t a, acb_t *w, acb_t *ww, int64_t prec, bool dd, const Lthreads_t *th);
+
+  // from dd_fft.c
+  bool dd_ifft(acb_t *x, uint64_t n, acb_t *w);
+
+  // from fixed_convolve.c
+  void fixed_vec_init(fixed_vec_t *f);
+  void fixed_vec_clear(fixed_vec_t *f);
+  void fixed_vec_set(fixed_vec_t *f, acb_t *x, uint64_t n, int64_t prec);
+  void fixed_sum_init(fixed_sum_t *s, uint64_t n);
+  void fixed_sum_clear(fixed_sum_t *s);
+  void fixed_convolve(fixed_sum_t *res, const fixed_vec_t *x, const fixed_vec_t *g);
+  void fixed_sum_add(fixed_sum_t *s, const fixed_sum_t *t);
+  void fixed_sum_get(acb_t *res, const fixed_sum_t *s, int64_t prec);
 
   // from error.c
   void abs_gamma(arb_t res, acb_t s, Lfunc *L, int64_t prec);
@@ -147,6 +263,9 @@ extern "C"{
 
   // from compute.c
   void lfunc_compute(Lfunc *L);
+  Ghat_t *get_Ghat(Lfunc *L, int64_t lo);
+  void release_Ghat(Lfunc *L, Ghat_t *gh);
+  void free_Ghat(Lfunc *L, Ghat_t *gh);
 
   //from upsample.c
   double upsample_error(long double M, long double H, long double h, long double A, double *mus, uint64_t r, uint64_t N, long double T, long double imz, uint64_t l);
@@ -157,6 +276,11 @@ extern "C"{
 
   //from zeros.c
   Lerror_t find_zeros(Lfunc *L, uint64_t side);
+  Lerror_t find_all_zeros(Lfunc *L);
+
+  // from threads.c
+  void default_threads(Lthreads_t *th);
+  void parallel_for(uint64_t n_jobs, const Lthreads_t *th, void (*job)(uint64_t j, uint64_t thread, void *arg), void *arg);
 
   // from rank.c
   //uint64_t guess_rank(Lfunc *L, uint64_t side, uint64_t prec);
@@ -1,5 +1,14 @@
+#include <pthread.h>
 #include "acb.h"
 #include "inttypes.h"
+#include "glfunc_internals.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+// don't bother splitting a stage into pieces smaller than this
+#define FFT_MIN_CHUNK (64)
 
 void acb_initfft(acb_t *w, uint64_t n, int64_t prec)
 {
@@ -16,15 +25,165 @@ void acb_initfft(acb_t *w, uint64_t n, int64_t prec)
   arb_clear(I);arb_clear(IN);
 } /* acb_initfft */
 
+// twiddle tables shared by everyone in the process, keyed by (n,prec).
+// tables nobody is using are kept (up to TWIDDLE_MAX_IDLE of them) so
+// the next Lfunc along finds them waiting.
+#define TWIDDLE_MAX_IDLE (4)
 
-// do inplace fft of x of length n a power of 2
-// w[i]=e(i/n) i=0..n/2-1
-void acb_fft(acb_t *x, uint64_t n, acb_t *w, int64_t prec) {
+typedef struct twiddle_s{
+  uint64_t n;
+  int64_t prec;
+  uint64_t refs;
+  acb_t *w; // w[i]=e(i/n) i=0..n/2-1
+  struct twiddle_s *next; // most recently used first
+} twiddle_t;
+
+static twiddle_t *twiddles=NULL;
+static pthread_mutex_t twiddle_lock=PTHREAD_MUTEX_INITIALIZER;
+
+static void free_twiddle(twiddle_t *t)
+{
+  for(uint64_t i=0;i<t->n/2;i++)
+    acb_clear(t->w[i]);
+  free(t->w);
+  free(t);
+}
+
+// return twiddles for an fft of length n at precision prec, computing
+// them only if we haven't got them already. If we have them at a
+// higher precision we just round those. release with release_twiddles.
+// returns NULL if out of memory.
+acb_t *get_twiddles(uint64_t n, int64_t prec)
+{
+  pthread_mutex_lock(&twiddle_lock);
+  twiddle_t **p,*t,*best=NULL;
+  for(p=&twiddles;*p;p=&(*p)->next)
+    if(((*p)->n==n)&&((*p)->prec>=prec))
+    {
+      if((*p)->prec==prec)
+        break;
+      if((!best)||((*p)->prec<best->prec))
+        best=*p;
+    }
+  t=*p;
+  if(t) // move it to the front
+    *p=t->next;
+  else
+  {
+    t=(twiddle_t *)malloc(sizeof(twiddle_t));
+    acb_t *w=(acb_t *)malloc(sizeof(acb_t)*(n/2));
+    if((!t)||(!w))
+    {
+      free(t);
+      free(w);
+      pthread_mutex_unlock(&twiddle_lock);
+      return NULL;
+    }
+    t->n=n;
+    t->prec=prec;
+    t->refs=0;
+    t->w=w;
+    for(uint64_t i=0;i<n/2;i++)
+      acb_init(w[i]);
+    if(best)
+      for(uint64_t i=0;i<n/2;i++)
+        acb_set_round(w[i],best->w[i],prec);
+    else
+      acb_initfft(w,n,prec);
+  }
+  t->refs++;
+  t->next=twiddles;
+  twiddles=t;
+  pthread_mutex_unlock(&twiddle_lock);
+  return t->w;
+}
+
+// say we have finished with a table from get_twiddles
+void release_twiddles(acb_t *w)
+{
+  if(!w)
+    return;
+  pthread_mutex_lock(&twiddle_lock);
+  uint64_t idle=0;
+  for(twiddle_t **p=&twiddles;*p;)
+  {
+    twiddle_t *t=*p;
+    if(t->w==w)
+      t->refs--;
+    if((t->refs==0)&&(++idle>TWIDDLE_MAX_IDLE))
+    {
+      *p=t->next; // least recently used idle tables go first
+      free_twiddle(t);
+      continue;
+    }
+    p=&t->next;
+  }
+  pthread_mutex_unlock(&twiddle_lock);
+}
+
+
+typedef struct{
+  acb_t *x;
+  acb_t *w;
+  uint64_t n;
+  uint64_t b; // length of the blocks done first
+  uint64_t chunk; // columns per job in the second half
+  int64_t prec;
+} fft_split_t;
+
+static inline void fft_butterfly(acb_t *p, uint64_t k, acb_t w, acb_t tmp, int64_t prec)
+{
+  acb_mul(tmp,p[k],w,prec);
+  acb_sub(p[k],p[0],tmp,prec);
+  acb_add(p[0],p[0],tmp,prec);
+}
+
+// the stages with k<b only mix entries within a block of length b,
+// so block j can be taken through all of them on its own
+static void fft_block(uint64_t j, uint64_t thread, void *arg)
+{
+  fft_split_t *sp=(fft_split_t *) arg;
+  (void) thread;
+  acb_t *x=sp->x+j*sp->b;
+  acb_t tmp;
+  acb_init(tmp);
+  for(uint64_t k=1;k<sp->b;k<<=1)
+  {
+    uint64_t l=sp->n/(2*k);
+    for(uint64_t i=0;i<sp->b;i+=2*k)
+      for(uint64_t u=0;u<k;u++)
+        fft_butterfly(x+i+u,k,sp->w[u*l],tmp,sp->prec);
+  }
+  acb_clear(tmp);
+}
+
+// the stages with k>=b then only mix entries in the same column, i.e.
+// with the same index mod b. do all of them for columns
+// j*chunk..(j+1)*chunk-1.
+static void fft_columns(uint64_t j, uint64_t thread, void *arg)
+{
+  fft_split_t *sp=(fft_split_t *) arg;
+  (void) thread;
+  uint64_t c0=j*sp->chunk,c1=c0+sp->chunk;
   acb_t tmp;
   acb_init(tmp);
+  for(uint64_t k=sp->b;k<sp->n;k<<=1)
+  {
+    uint64_t l=sp->n/(2*k);
+    for(uint64_t i=0;i<sp->n;i+=2*k)
+      for(uint64_t t=0;t<k;t+=sp->b)
+        for(uint64_t u=t+c0;u<t+c1;u++)
+          fft_butterfly(sp->x+i+u,k,sp->w[u*l],tmp,sp->prec);
+  }
+  acb_clear(tmp);
+}
 
+// do inplace fft of x of length n a power of 2
+// w[i]=e(i/n) i=0..n/2-1
+// with threads the transform is split into blocks, then columns, so
+// there are only two rounds of parallel_for whatever n is
+void acb_fft(acb_t *x, uint64_t n, acb_t *w, int64_t prec, const Lthreads_t *th) {
   uint64_t i,j,k,l;
-  acb_t *p,*xend=x+n;
 
   for(i=0,l=n>>1;i<l;++i)
     {
@@ -43,57 +202,239 @@ void acb_fft(acb_t *x, uint64_t n, acb_t *w, int64_t prec) {
       acb_swap(x[i],x[j]);
     }
 
-  for(k=1,l=n/2;k<n;k<<=1,l>>=1)
-    for(p=x;p<xend;p+=k)
-      for(j=0;j<n/2;j+=l,p++)
-	{
-	  acb_mul(tmp,p[k],w[j],prec);
-	  acb_sub(p[k],p[0],tmp,prec);
-	  acb_add(p[0],p[0],tmp,prec);
-	}
-  acb_clear(tmp);
+  // a power of 2 number of blocks, a few per thread so they balance out
+  uint64_t n_jobs=1;
+  if(th->n_threads>1)
+    while((n_jobs<4*th->n_threads)&&(n/2/n_jobs>=2*FFT_MIN_CHUNK))
+      n_jobs<<=1;
+  fft_split_t sp;
+  sp.x=x;
+  sp.w=w;
+  sp.n=n;
+  sp.b=n/n_jobs;
+  sp.prec=prec;
+  parallel_for(n_jobs,th,fft_block,&sp);
+  if(n_jobs==1) // the one block was everything
+    return;
+  uint64_t n_col_jobs=(n_jobs<sp.b) ? n_jobs : sp.b;
+  sp.chunk=sp.b/n_col_jobs;
+  parallel_for(n_col_jobs,th,fft_columns,&sp);
 } /* acb_fft */
 
 // non normalised inverse dft
-void acb_ifft(acb_t *x, uint64_t n, acb_t *w, uint64_t prec)
+void acb_ifft(acb_t *x, uint64_t n, acb_t *w, int64_t prec, const Lthreads_t *th)
 {
-  acb_fft(x,n,w,prec);
+  acb_fft(x,n,w,prec,th);
   for(uint64_t i=1;i<n/2;++i)
     acb_swap(x[i],x[n-i]);
 }
 
 // x,y must be distinct
-void acb_convolve(acb_t *res, acb_t *x, acb_t *y, uint64_t n, acb_t *w, uint64_t prec)
+void acb_convolve(acb_t *res, acb_t *x, acb_t *y, uint64_t n, acb_t *w, int64_t prec, const Lthreads_t *th)
 {
-  acb_fft(x,n,w,prec);
-  acb_fft(y,n,w,prec);
+  acb_fft(x,n,w,prec,th);
+  acb_fft(y,n,w,prec,th);
   for(uint64_t i=0;i<n;++i)
     acb_mul(res[i],x[i],y[i],prec);
-  acb_ifft(res,n,w,prec);
+  acb_ifft(res,n,w,prec,th);
   for(uint64_t i=0;i<n;++i)
     acb_div_ui(res[i],res[i],n,prec);
 }
 
 // x,y must be distinct. y has already been fft'd
-void acb_convolve1(acb_t *res, acb_t *x, acb_t *y, uint64_t n, acb_t *w, uint64_t prec)
+void acb_convolve1(acb_t *res, acb_t *x, acb_t *y, uint64_t n, acb_t *w, int64_t prec, const Lthreads_t *th)
 {
-  acb_fft(x,n,w,prec);
+  acb_fft(x,n,w,prec,th);
   //fft(y,n,w,prec);
   for(uint64_t i=0;i<n;++i)
     acb_mul(res[i],x[i],y[i],prec);
-  acb_ifft(res,n,w,prec);
+  acb_ifft(res,n,w,prec,th);
   for(uint64_t i=0;i<n;++i)
     acb_div_ui(res[i],res[i],n,prec);
 }
 
 // x and y have already been fft'd
-void acb_convolve2(acb_t *res, acb_t *x, acb_t *y, uint64_t n, acb_t *w, uint64_t prec) {
+void acb_convolve2(acb_t *res, acb_t *x, acb_t *y, uint64_t n, acb_t *w, int64_t prec, const Lthreads_t *th) {
   //acb_fft(x,n,w,prec);
   //fft(y,n,w,prec);
   for(uint64_t i=0;i<n;++i)
     acb_mul(res[i],x[i],y[i],prec);
-  acb_ifft(res,n,w,prec);
+  acb_ifft(res,n,w,prec,th);
   for(uint64_t i=0;i<n;++i)
     acb_div_ui(res[i],res[i],n,prec);
 }
 
+// x and y hold real sequences (their imaginary parts are ignored).
+// transform both with one complex fft of x+iy, using
+// X[k]=(Z[k]+conj(Z[n-k]))/2 and Y[k]=(Z[k]-conj(Z[n-k]))/2i
+void acb_fft_real2(acb_t *x, acb_t *y, uint64_t n, acb_t *w, int64_t prec, const Lthreads_t *th)
+{
+  for(uint64_t i=0;i<n;++i)
+    arb_swap(acb_imagref(x[i]),acb_realref(y[i]));
+  acb_fft(x,n,w,prec,th);
+  acb_t zc;
+  acb_init(zc);
+  for(uint64_t i=0;i<=n/2;++i)
+  {
+    uint64_t j=(n-i)%n;
+    // we need both of Z[i] and Z[j] for both of i and j
+    acb_conj(zc,x[j]);
+    acb_sub(y[i],x[i],zc,prec);
+    acb_add(x[i],x[i],zc,prec);
+    acb_mul_2exp_si(x[i],x[i],-1);
+    acb_mul_2exp_si(y[i],y[i],-1);
+    acb_div_onei(y[i],y[i]);
+    if(j!=i) // X[j]=conj(X[i]) and Y[j]=conj(Y[i])
+    {
+      acb_conj(x[j],x[i]);
+      acb_conj(y[j],y[i]);
+    }
+  }
+  acb_clear(zc);
+}
+
+typedef struct{
+  acb_t *res;
+  acb_t *x;
+  acb_t **y; // a length m workspace per thread
+  acb_t *w;
+  acb_t *ww;
+  uint64_t m,n,a;
+  int64_t prec;
+  bool dd;
+  Lthreads_t one; // each length m ifft runs on a single thread
+} ifft_pruned_t;
+
+// the outputs res[rq+s] q=0..m-1 of acb_ifft_pruned
+static void ifft_pruned_job(uint64_t s, uint64_t thread, void *arg)
+{
+  ifft_pruned_t *p=(ifft_pruned_t *) arg;
+  uint64_t m=p->m,n=p->n,r=n/m;
+  acb_t *y=p->y[thread];
+  acb_t tmp;
+  acb_init(tmp);
+  for(uint64_t j=0;j<m;j++)
+  {
+    uint64_t t=j*s; // < n, e(-t/n)=conj(ww[t]) or -conj(ww[t-n/2])
+    acb_conj(tmp,p->ww[t%(n/2)]);
+    if(t>=n/2)
+      acb_neg(tmp,tmp);
+    acb_mul(y[j],p->x[j],tmp,p->prec);
+  }
+  acb_clear(tmp);
+  if((!p->dd)||!dd_ifft(y,m,p->w))
+    acb_ifft(y,m,p->w,p->prec,&p->one);
+  for(uint64_t q=0;q<m;q++)
+  {
+    uint64_t k=r*q+s;
+    if((k<=p->a)||(k>=n-p->a))
+      acb_swap(p->res[k],y[q]);
+  }
+}
+
+// res[k]=sum_{j<m} x[j]e(-jk/n), as acb_ifft would give if x were
+// padded with zeros to length n, but only for k=-a..a (mod n). The
+// other res are left alone and x must not overlap res. m and n/m are
+// powers of 2, w are the twiddles for length m and ww for length n.
+// writing k=rq+s with r=n/m this is r length m iffts of
+// x[j]e(-js/n), so about log(m)/log(n) of the butterflies. If dd
+// these are done by dd_ifft where it can. returns false if out of
+// memory.
+bool acb_ifft_pruned(acb_t *res, acb_t *x, uint64_t m, uint64_t n, uint64_t a, acb_t *w, acb_t *ww, int64_t prec, bool dd, const Lthreads_t *th)
+{
+  uint64_t n_threads=th->n_threads;
+  if(n_threads>n/m)
+    n_threads=n/m;
+  if(n_threads<1)
+    n_threads=1;
+  ifft_pruned_t p;
+  p.y=(acb_t **)calloc(n_threads,sizeof(acb_t *));
+  if(!p.y)
+    return false;
+  bool ok=true;
+  for(uint64_t t=0;ok&&(t<n_threads);t++)
+  {
+    p.y[t]=(acb_t *)malloc(sizeof(acb_t)*m);
+    ok=(p.y[t]!=NULL);
+    if(ok)
+      for(uint64_t j=0;j<m;j++)
+        acb_init(p.y[t][j]);
+  }
+  if(ok)
+  {
+    p.res=res;
+    p.x=x;
+    p.w=w;
+    p.ww=ww;
+    p.m=m;
+    p.n=n;
+    p.a=a;
+    p.prec=prec;
+    p.dd=dd;
+    p.one=*th;
+    p.one.n_threads=1;
+    parallel_for(n/m,th,ifft_pruned_job,&p);
+  }
+  for(uint64_t t=0;t<n_threads;t++)
+    if(p.y[t])
+    {
+      for(uint64_t j=0;j<m;j++)
+        acb_clear(p.y[t][j]);
+      free(p.y[t]);
+    }
+  free(p.y);
+  return ok;
+}
+
+// x[0..nn-1] is Hermitian, x[nn-j]=conj(x[j]), and x[m..nn-m] are
+// no more than error balls. Then for k=-a..a (mod nn)
+//   Re iFFT(x)[k] = 2Re(sum_{j<m} x[j]e(-jk/nn))-Re(x[0]) +/- E
+// with E the sum of |x[m..nn-m]|, and acb_ifft_pruned does the sum.
+// Those Re iFFT(x)[k] are left in x[k] with zero imaginary part, and
+// the other x[k] are zeroed. returns false, with x untouched, if out
+// of memory.
+bool acb_ifft_hermitian(acb_t *x, uint64_t m, uint64_t nn, uint64_t a, acb_t *w, acb_t *ww, int64_t prec, bool dd, const Lthreads_t *th)
+{
+  acb_t *y=(acb_t *)malloc(sizeof(acb_t)*m);
+  if(!y)
+    return false;
+  mag_t E,t;
+  mag_init(E);
+  mag_init(t);
+  for(uint64_t j=m;j<=nn-m;j++)
+  {
+    acb_get_mag(t,x[j]);
+    mag_add(E,E,t);
+  }
+  for(uint64_t j=0;j<m;j++)
+  {
+    acb_init(y[j]);
+    acb_swap(y[j],x[j]);
+  }
+  bool ok=acb_ifft_pruned(x,y,m,nn,a,w,ww,prec,dd,th);
+  if(!ok) // put it back
+    for(uint64_t j=0;j<m;j++)
+      acb_swap(x[j],y[j]);
+  for(uint64_t k=0;ok&&(k<nn);k++)
+  {
+    if((k>a)&&(k<nn-a)) // nothing will look at these
+    {
+      acb_zero(x[k]);
+      continue;
+    }
+    arb_mul_2exp_si(acb_realref(x[k]),acb_realref(x[k]),1);
+    arb_sub(acb_realref(x[k]),acb_realref(x[k]),acb_realref(y[0]),prec);
+    arb_add_error_mag(acb_realref(x[k]),E);
+    arb_zero(acb_imagref(x[k]));
+  }
+  for(uint64_t j=0;j<m;j++)
+    acb_clear(y[j]);
+  free(y);
+  mag_clear(E);
+  mag_clear(t);
+  return ok;
+}
+
+#ifdef __cplusplus
+}
+#endif
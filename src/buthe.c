@@ -40,9 +40,7 @@ extern "C"{
       arb_add_error(L->buthe_ints[i],one);
       arb_mul_2exp_si(L->buthe_ints[i],L->buthe_ints[i],BUTHE_INT_SHIFT);
     }
-    arb_init(L->buthe_Wf);
-    arb_init(L->buthe_Winf);
-    arb_init(L->buthe_Ws);
+    // Wf, Winf and Ws belong to each Lfunc, see instance_init
     arb_init(L->buthe_b); // will confirm RH in [0,b]
     arb_init(L->buthe_sig1);
     arb_init(L->buthe_C);
@@ -135,14 +133,9 @@ extern "C"{
   // fp1 is f^-1, fp is f
   void wf(Lfunc *L, uint64_t p, acb_poly_t fp1, acb_poly_t fp, int64_t prec)
   {
-    static bool init=false;
-    static acb_t tmp1,acm;
-    if(!init)
-    {
-      init=true;
-      acb_init(tmp1);
-      acb_init(acm);
-    }
+    acb_t tmp1,acm;
+    acb_init(tmp1);
+    acb_init(acm);
 
     uint64_t pm=p,m=1;
     //if(verbose) if(p==2) {printf("p=%lu\n",p);acb_poly_printd(fp,20);printf("\n--------\n");acb_poly_printd(fp1,20);printf("\n--------\n");}
@@ -161,6 +154,8 @@ extern "C"{
       pm*=p;
       m++;
     }
+    acb_clear(tmp1);
+    acb_clear(acm);
   }
 
 
@@ -192,16 +187,11 @@ extern "C"{
 
   void buthe_fhat(arb_t res, arb_t z, Lfunc *L, int64_t prec)
   {
-    static bool init=false;
-    static arb_t tmp,tmp1,tmp2,tmp3;
-    if(!init)
-    {
-      init=true;
-      arb_init(tmp);
-      arb_init(tmp1);
-      arb_init(tmp2);
-      arb_init(tmp3);
-    }
+    arb_t tmp,tmp1,tmp2,tmp3;
+    arb_init(tmp);
+    arb_init(tmp1);
+    arb_init(tmp2);
+    arb_init(tmp3);
     arb_div(tmp,L->pi,L->buthe_h,prec); // Pi/h
     arb_add(tmp1,z,L->buthe_b,prec); // z+b
     arb_mul(tmp2,tmp,tmp1,prec); // Pi/h z
@@ -214,20 +204,19 @@ extern "C"{
     arb_sub(tmp,tmp2,tmp3,prec);
     arb_div(res,tmp,L->pi,prec);
     arb_mul_2exp_si(res,res,1); // 2/Pi*(atan - atan)
+    arb_clear(tmp);
+    arb_clear(tmp1);
+    arb_clear(tmp2);
+    arb_clear(tmp3);
   }
 
 
   // sum over zeros for a dual l-function
   void buthe_Ws_dual(arb_t res, Lfunc *Lf, arb_t *zeros, int64_t prec)
   {
-    static bool init=false;
-    static arb_t tmp,tmp1;
-    if(!init)
-    {
-      init=true;
-      arb_init(tmp);
-      arb_init(tmp1);
-    }
+    arb_t tmp,tmp1;
+    arb_init(tmp);
+    arb_init(tmp1);
     for(uint64_t z=0;;z++)
     {
       if((z==MAX_ZEROS)||(arb_is_zero(zeros[z])))
@@ -247,18 +236,16 @@ extern "C"{
       arb_mul_ui(tmp1,tmp,Lf->rank,prec);
       arb_add(res,res,tmp1,prec);
     }
+    arb_clear(tmp);
+    arb_clear(tmp1);
   }
 
   // sum over zeros for a non-dual l-function (will work with dual as well)
   void buthe_Ws_non_dual(arb_t res, Lfunc *Lf, arb_t *zeros, uint64_t side, int64_t prec)
   {
-    static bool init=false;
-    static arb_t tmp,tmp1;
-    if(!init) {
-      init=true;
-      arb_init(tmp);
-      arb_init(tmp1);
-    }
+    arb_t tmp,tmp1;
+    arb_init(tmp);
+    arb_init(tmp1);
     for(uint64_t z=0;;z++)
     {
       if((z==MAX_ZEROS)||(arb_is_zero(zeros[z])))
@@ -277,54 +264,47 @@ extern "C"{
       arb_mul_ui(tmp1,tmp,Lf->rank,prec);
       arb_add(res,res,tmp1,prec);
     }
+    arb_clear(tmp);
+    arb_clear(tmp1);
   }
 
   // add digamma(1/4+mu/2)
   void buthe_lgam1(arb_t res, double mu, int64_t prec)
   {
-    static bool init=false;
-    static arb_t s,tmp;
-    if(!init)
-    {
-      arb_init(s);
-      arb_init(tmp);
-    }
+    arb_t s,tmp;
+    arb_init(s);
+    arb_init(tmp);
     arb_set_d(s,1.0/4.0+(double)mu/2.0); // all normalised to (1-s)
     arb_digamma(tmp,s,prec);
     //if(verbose) {printf("lgam1(%f) returning ",mu);arb_printd(tmp,20);printf("\n");}
     arb_add(res,res,tmp,prec);
+    arb_clear(s);
+    arb_clear(tmp);
   }
 
   // add log N - r log pi
   void buthe_lgam2(arb_t res, uint64_t r, uint64_t N, arb_t logpi, int64_t prec)
   {
-    static bool init=false;
-    static arb_t tmp,tmp1,tmp2,tmp3;
-    if(!init)
-    {
-      init=true;
-      arb_init(tmp);
-      arb_init(tmp1);
-      arb_init(tmp2);
-      arb_init(tmp3);
-    }
+    arb_t tmp1,tmp2,tmp3;
+    arb_init(tmp1);
+    arb_init(tmp2);
+    arb_init(tmp3);
     arb_log_ui(tmp1,N,prec); // log N
     arb_mul_ui(tmp2,logpi,r,prec); // log Pi^r
     arb_sub(tmp3,tmp1,tmp2,prec); // log(N/Pi^r)
     if(verbose){printf("lgam2 adding ");arb_printd(tmp3,20);printf("\n");}
     arb_add(res,res,tmp3,prec);
+    arb_clear(tmp1);
+    arb_clear(tmp2);
+    arb_clear(tmp3);
   }
 
   void buthe_Winf(arb_t res, Lfunc *L, int64_t prec)
   {
-    static bool init=false;
-    static arb_t tmp,tmp1,logpi;
-    if(!init) {
-      init=true;
-      arb_init(tmp);
-      arb_init(tmp1);
-      arb_init(logpi);
-    }
+    arb_t tmp,tmp1,logpi;
+    arb_init(tmp);
+    arb_init(tmp1);
+    arb_init(logpi);
     arb_log(logpi,L->pi,prec);
     arb_zero(res);
     for(uint64_t k=0;k<L->degree;k++)
@@ -359,20 +339,19 @@ extern "C"{
       arb_add(res,res,tmp,prec);
     }
     if(verbose) {printf("Winf = ");arb_printd(res,20);printf("\n");}
+    arb_clear(tmp);
+    arb_clear(tmp1);
+    arb_clear(logpi);
   }
 
   Lerror_t buthe_check_RH(Lfunc *L)
   {
-    static bool init=false;
-    static arb_t sum,two_zeros;
-    if(!init) {
-      init=true;
-      arb_init(sum);
-      arb_init(two_zeros);
-      arb_set_ui(two_zeros,98);
-      arb_div_ui(two_zeros,two_zeros,100,100);
-    }
     int64_t prec=L->wprec;
+    arb_t sum,two_zeros;
+    arb_init(sum);
+    arb_init(two_zeros);
+    arb_set_ui(two_zeros,98);
+    arb_div_ui(two_zeros,two_zeros,100,100);
     if(verbose)
     {printf("Going to use Weil-Barner to confirm list of zeros.\n");fflush(stdout);}
     arb_zero(L->buthe_Ws);
@@ -401,17 +380,22 @@ extern "C"{
     if(arb_is_negative(sum))
     {
       if(verbose) printf("Error in Weil-Barner check. Winf+Wf-Ws* must allow >=0. RH not confirmed.\n");
+      arb_clear(sum);
+      arb_clear(two_zeros);
       return ERR_BUT_ERROR;
     }
 
     arb_sub(sum,sum,two_zeros,prec);
 
+    Lerror_t ecode=ERR_SUCCESS;
     if(!arb_is_negative(sum))
     {
       if(verbose) printf("Looks like we've missed a some (pairs of) zeros.\n");
-      return ERR_RH_ERROR;
+      ecode=ERR_RH_ERROR;
     }
-    return ERR_SUCCESS;
+    arb_clear(sum);
+    arb_clear(two_zeros);
+    return ecode;
   }
 
 #ifdef __cplusplus
@@ -9,9 +9,10 @@ extern "C"{
 #define acb_cclear(x) if(x) acb_clear(x)
 #define arf_cclear(x) if(x) arf_clear(x)
 
-  void Lfunc_clear(Lfunc_t LL)
+  // the parts family_init set up
+  void Lfamily_clear(Lfamily_t FF)
   {
-    Lfunc *L=(Lfunc *) LL;
+    Lfunc *L=(Lfunc *) FF;
 
     free(L->mus);
     arb_cclear(L->zero_prec);
@@ -30,20 +31,40 @@ extern "C"{
     arb_cclear(L->two_pi_by_B);
     arb_cclear(L->pi);
     arb_cclear(L->eq59);
-    if(L->Gs)
-      {
-	for(uint64_t k=0;k<L->max_K;k++)
-	  if(L->Gs[k])
-	    {
-	      for(int64_t i=0;i<=L->hi_i-L->low_i;i++)
-		arb_cclear(L->Gs[k][i]);
-	      free(L->Gs[k]);
-	    }
-	free(L->Gs);
-      }
+    while(L->Ghat)
+    {
+      Ghat_t *gh=L->Ghat;
+      L->Ghat=gh->next;
+      free_Ghat(L,gh);
+    }
+    clear_Gs(L);
 
     arb_cclear(L->arb_A);
     arb_cclear(L->one_over_A);
+    arb_cclear(L->delta);
+    arb_cclear(L->exp_delta);
+    arb_cclear(L->pre_ftwiddle_error);
+    arb_cclear(L->buthe_b);
+    arb_cclear(L->buthe_sig1);
+    arb_cclear(L->buthe_C);
+    arb_cclear(L->buthe_h);
+    for(uint64_t i=0;i<(MAX_R-1)*(2*MAX_MUI_2+1);i++)
+      arb_cclear(L->buthe_ints[i]);
+
+    release_twiddles(L->w);
+    release_twiddles(L->ww);
+
+    arf_cclear(L->arf_A);
+    arf_cclear(L->arf_one_over_A);
+
+    free(L);
+  }
+
+  // the parts instance_init set up, then the family if it's ours
+  void Lfunc_clear(Lfunc_t LL)
+  {
+    Lfunc *L=(Lfunc *) LL;
+
     for(uint64_t side=0;side<2;side++)
       if(L->zeros[side])
 	{
@@ -51,19 +72,10 @@ extern "C"{
 	    arb_cclear(L->zeros[side][z]);
 	  free(L->zeros[side]);
 	}
-    arb_cclear(L->delta);
-    arb_cclear(L->exp_delta);
-    arb_cclear(L->pre_ftwiddle_error);
     arb_cclear(L->ftwiddle_error);
     arb_cclear(L->buthe_Wf);
     arb_cclear(L->buthe_Winf);
     arb_cclear(L->buthe_Ws);
-    arb_cclear(L->buthe_b);
-    arb_cclear(L->buthe_sig1);
-    arb_cclear(L->buthe_C);
-    arb_cclear(L->buthe_h);
-    for(uint64_t i=0;i<(MAX_R-1)*(2*MAX_MUI_2+1);i++)
-      arb_cclear(L->buthe_ints[i]);
     arb_cclear(L->one_over_root_N);
     arb_cclear(L->sum_ans);
     arb_cclear(L->u_H);
@@ -82,30 +94,6 @@ extern "C"{
     arb_cclear(L->Lam_d);
     arb_cclear(L->L_d);
     
-    if(L->G)
-      {
-	for(uint64_t i=0;i<L->fft_N;i++)
-	  acb_cclear(L->G[i]);
-	free(L->G);
-      }
-    if(L->w)
-      {
-	for(uint64_t i=0;i<L->fft_N/2;i++)
-	  acb_cclear(L->w[i]);
-	free(L->w);
-      }
-    if(L->ww)
-      {
-	for(uint64_t i=0;i<L->fft_NN/2;i++)
-	  acb_cclear(L->ww[i]);
-	free(L->ww);
-      }
-    if(L->kres)
-      {
-	for(uint64_t i=0;i<L->fft_N;i++)
-	  acb_cclear(L->kres[i]);
-	free(L->kres);
-      }
     if(L->skm)
       {
 	for(uint64_t k=0;k<L->max_K;k++)
@@ -132,9 +120,8 @@ extern "C"{
 	free(L->ans);
       }
 
-    arf_cclear(L->arf_A);
-    arf_cclear(L->arf_one_over_A);
-
+    if(L->owns_family)
+      Lfamily_clear((Lfamily_t) L->family);
     free(L);
   }
 #ifdef __cplusplus
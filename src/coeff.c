@@ -87,46 +87,51 @@ uint64_t Lfunc_nmax(Lfunc_t Lf)
 }
 
 
-void use_inv_lpoly(Lfunc *L, uint64_t p, acb_poly_t c, acb_poly_t f, uint64_t prec)
+// use inverted poly to populate Dirichlet coefficients a_n for n0<=n<=n1
+void apply_inv_lpoly(Lfunc *L, uint64_t p, acb_poly_t c, uint64_t n0, uint64_t n1, uint64_t prec)
 {
   acb_t tmp;
   acb_init(tmp);
-  //if(p==2) {printf("p=%" PRIu64 " 1/poly=",p);acb_poly_printd(c,20);printf("\npoly=");acb_poly_printd(f,20);printf("\n");}
-  wf(L, p, c, f, prec); // do the Buthe bit, see buthe.c
-  // use inverted poly to populate Dirichlet coefficients
-  uint64_t pnn=p*p, pn=p,pow=1;
-  while(pn <= L->M) {
+  if(n1 > L->M)
+    n1 = L->M;
+  uint64_t pn=p,pow=1;
+  while(pn <= n1) {
     acb_poly_get_coeff_acb(tmp, c, pow);
-    uint64_t ptr = pn, count = 1;
-    while(ptr <= L->M) {
-      if(count < p) {// its not a higher prime power
+    // start from the first multiple of p^pow in range
+    uint64_t count = (n0+pn-1)/pn;
+    uint64_t ptr = count*pn;
+    count %= p;
+    while(ptr <= n1) {
+      if(count != 0) // its not a higher prime power
         acb_mul(L->ans[ptr-1], L->ans[ptr-1], tmp, prec);
-        count++;
-        ptr += pn;
-      } else {// it is higher prime power, so skip it
-        ptr += pn;
-        count = 1;
-      }
+      ptr += pn;
+      if(++count == p)
+        count = 0;
     }
     pn *= p;
-    pnn *= p;
     pow++;
   }
   acb_clear(tmp);
 }
 
-void use_lpoly(Lfunc *L, uint64_t p, const acb_poly_t f)
+void use_inv_lpoly(Lfunc *L, uint64_t p, acb_poly_t c, acb_poly_t f, uint64_t prec)
+{
+  //if(p==2) {printf("p=%" PRIu64 " 1/poly=",p);acb_poly_printd(c,20);printf("\npoly=");acb_poly_printd(f,20);printf("\n");}
+  wf(L, p, c, f, prec); // do the Buthe bit, see buthe.c
+  apply_inv_lpoly(L, p, c, 1, L->M, prec);
+}
+
+// normalise the Euler poly f at p into n_poly and
+// set inv_poly to enough terms of its inverse
+void prepare_lpoly(acb_poly_t n_poly, acb_poly_t inv_poly, Lfunc *L, uint64_t p, const acb_poly_t f)
 {
   int64_t prec=L->wprec;
   acb_t tmp;
   arb_t logp,tmp1,tmp2;
-  acb_poly_t n_poly,inv_poly;
   arb_init(logp);
   acb_init(tmp);
   arb_init(tmp1);
   arb_init(tmp2);
-  acb_poly_init(n_poly);
-  acb_poly_init(inv_poly);
   //if(p<=2){printf("in use_lpoly pre-norm with p = %" PRIu64 "\n",p);acb_poly_printd(f,20);printf("\n");}
   arb_log_ui(logp,p,prec);
   // normalise by multiplying each term by p^(-m norm)
@@ -148,14 +153,21 @@ void use_lpoly(Lfunc *L, uint64_t p, const acb_poly_t f)
   //if(p<=11){printf("Inverted poly\n");
   //acb_poly_printd(inv_poly,20);printf("\n------------------\n");
   //}
-  use_inv_lpoly(L,p,inv_poly,n_poly,prec);
   arb_clear(logp);
   acb_clear(tmp);
   arb_clear(tmp1);
   arb_clear(tmp2);
+}
+
+void use_lpoly(Lfunc *L, uint64_t p, const acb_poly_t f)
+{
+  acb_poly_t n_poly,inv_poly;
+  acb_poly_init(n_poly);
+  acb_poly_init(inv_poly);
+  prepare_lpoly(n_poly,inv_poly,L,p,f);
+  use_inv_lpoly(L,p,inv_poly,n_poly,L->wprec);
   acb_poly_clear(n_poly);
   acb_poly_clear(inv_poly);
-
 }
 
 void Lfunc_use_lpoly(Lfunc_t Lf, uint64_t p, const acb_poly_t poly)
@@ -207,6 +219,138 @@ Lerror_t Lfunc_use_all_lpolys(Lfunc_t Lf, void (*lpoly_callback) (acb_poly_t lpo
   return ecode;
 }
 
+// how many primes to hand out per thread in each batch
+#define LPOLY_BATCH (4096)
+// don't split the coefficients into ranges shorter than this
+#define LPOLY_MIN_RANGE (4096)
+
+typedef struct{
+  Lfunc *L;
+  void (*lpoly_callback) (acb_poly_t lpoly, uint64_t p, int d, int64_t prec, void *parm);
+  void *param;
+  uint64_t *ps; // the primes in this batch
+  acb_poly_t *n_polys,*inv_polys;
+  bool *zero; // did the callback return 0 for this prime
+  uint64_t n_ps; // primes we are going to use from this batch
+  uint64_t n_ranges; // the coefficients 1..M are split into this many ranges
+} lpoly_batch_t;
+
+// call the callback for the j'th prime of the batch and prepare its poly
+void lpoly_callback_job(uint64_t j, uint64_t thread, void *arg)
+{
+  lpoly_batch_t *lb=(lpoly_batch_t *) arg;
+  (void) thread;
+  acb_poly_t lp;
+  acb_poly_init(lp);
+  lb->lpoly_callback(lp,lb->ps[j],lb->L->degree,lb->L->wprec,lb->param);
+  lb->zero[j]=acb_poly_is_zero(lp);
+  if(!lb->zero[j])
+    prepare_lpoly(lb->n_polys[j],lb->inv_polys[j],lb->L,lb->ps[j],lp);
+  acb_poly_clear(lp);
+}
+
+// apply every prime of the batch, in order, to the j'th range of coefficients
+void lpoly_apply_job(uint64_t j, uint64_t thread, void *arg)
+{
+  lpoly_batch_t *lb=(lpoly_batch_t *) arg;
+  Lfunc *L=lb->L;
+  (void) thread;
+  uint64_t n0=1+L->M*j/lb->n_ranges,n1=L->M*(j+1)/lb->n_ranges;
+  for(uint64_t i=0;i<lb->n_ps;i++)
+    apply_inv_lpoly(L,lb->ps[i],lb->inv_polys[i],n0,n1,L->wprec);
+}
+
+// as Lfunc_use_all_lpolys, but the primes are taken in batches.
+// The callback is called for each prime in a batch from several threads
+// at once, then each thread multiplies the batch into its own range of
+// a_n. Each a_n still sees the primes in increasing order, so the result
+// is identical to the serial version.
+Lerror_t Lfunc_use_all_lpolys_parallel(Lfunc_t Lf, void (*lpoly_callback) (acb_poly_t lpoly, uint64_t p, int d, int64_t prec, void *parm), void *param)
+{
+  Lfunc *L;
+  L=(Lfunc *)Lf;
+  if(L->threads.n_threads<=1)
+    return Lfunc_use_all_lpolys(Lf,lpoly_callback,param);
+  if(!L->nmax_called)
+  {
+    L->M=Lfunc_nmax(Lf);
+    L->nmax_called=true;
+  }
+
+  lpoly_batch_t lb;
+  uint64_t batch=LPOLY_BATCH*L->threads.n_threads;
+  lb.L=L;
+  lb.lpoly_callback=lpoly_callback;
+  lb.param=param;
+  lb.ps=(uint64_t *)malloc(sizeof(uint64_t)*batch);
+  lb.n_polys=(acb_poly_t *)malloc(sizeof(acb_poly_t)*batch);
+  lb.inv_polys=(acb_poly_t *)malloc(sizeof(acb_poly_t)*batch);
+  lb.zero=(bool *)malloc(sizeof(bool)*batch);
+  if((!lb.ps)||(!lb.n_polys)||(!lb.inv_polys)||(!lb.zero))
+  {
+    free(lb.ps);
+    free(lb.n_polys);
+    free(lb.inv_polys);
+    free(lb.zero);
+    return Lfunc_use_all_lpolys(Lf,lpoly_callback,param);
+  }
+  for(uint64_t i=0;i<batch;i++)
+  {
+    acb_poly_init(lb.n_polys[i]);
+    acb_poly_init(lb.inv_polys[i]);
+  }
+  lb.n_ranges=4*L->threads.n_threads;
+  if(lb.n_ranges>L->M/LPOLY_MIN_RANGE)
+    lb.n_ranges=L->M/LPOLY_MIN_RANGE;
+  if(lb.n_ranges<1)
+    lb.n_ranges=1;
+
+  primesieve_iterator it;
+  primesieve_init(&it);
+  uint64_t p=primesieve_next_prime(&it);
+  Lerror_t ecode=ERR_SUCCESS;
+  while(p <= L->M)
+  {
+    uint64_t n_ps=0;
+    while((n_ps<batch)&&(p<=L->M))
+    {
+      lb.ps[n_ps++]=p;
+      p=primesieve_next_prime(&it);
+    }
+    parallel_for(n_ps,&L->threads,lpoly_callback_job,&lb);
+
+    // only use the primes before the first zero poly
+    for(lb.n_ps=0;lb.n_ps<n_ps;lb.n_ps++)
+      if(lb.zero[lb.n_ps])
+        break;
+    for(uint64_t i=0;i<lb.n_ps;i++)
+      wf(L,lb.ps[i],lb.inv_polys[i],lb.n_polys[i],L->wprec); // Buthe bit, in order
+    parallel_for(lb.n_ranges,&L->threads,lpoly_apply_job,&lb);
+
+    if(lb.n_ps<n_ps) // ran out of Euler polys
+    {
+      uint64_t q=lb.ps[lb.n_ps];
+      if(q<L->buthe_M)
+        L->buthe_M=q-1; // this is likely to mean we compute garbage
+      L->M=q-1; // we might get away with this
+      ecode|=ERR_INSUFF_EULER;
+      break;
+    }
+  }
+
+  primesieve_free_iterator(&it);
+  for(uint64_t i=0;i<batch;i++)
+  {
+    acb_poly_clear(lb.n_polys[i]);
+    acb_poly_clear(lb.inv_polys[i]);
+  }
+  free(lb.ps);
+  free(lb.n_polys);
+  free(lb.inv_polys);
+  free(lb.zero);
+  return ecode;
+}
+
 bool Lfunc_reduce_nmax(Lfunc_t LL, uint64_t nmax)
 {
   Lfunc *L=(Lfunc *)LL;
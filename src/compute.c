@@ -87,23 +87,22 @@ int64_t calc_m(uint64_t i, double two_pi_by_B, double dc)
 // sks=log(m/sqrt{N})-u_m
 void comp_sks(arb_t sks, uint64_t m, int64_t ms, Lfunc *L, int64_t prec)
 {
-  static bool init=false;
-  static arb_t tmp1,tmp2,tmp3;
-  if(!init)
-  {
-    init=true;
-    arb_init(tmp1);
-    arb_init(tmp2);
-    arb_init(tmp3);
-  }
+  arb_t tmp1,tmp2,tmp3;
+  arb_init(tmp1);
+  arb_init(tmp2);
+  arb_init(tmp3);
   arb_mul_si(tmp1,L->two_pi_by_B,ms,prec);
   arb_mul_ui(tmp2,L->one_over_root_N,m+1,prec);
   arb_log(tmp3,tmp2,prec);
   arb_sub(sks,tmp3,tmp1,prec);
+  arb_clear(tmp1);
+  arb_clear(tmp2);
+  arb_clear(tmp3);
 }
 
-// just check our G values go down far enough
-void finalise_comp(Lfunc *L)
+// check our G values go down far enough and get the rows from
+// offset-1 up, which are all this conductor will use
+Lerror_t finalise_comp(Lfunc *L)
 {
   double two_pi_by_B=L->one_over_B*2*M_PI;
   L->offset=calc_m(1,two_pi_by_B,L->dc);
@@ -113,60 +112,286 @@ void finalise_comp(Lfunc *L)
         L->offset,L->low_i);
     exit(0);
   }
+  return need_G(L,L->offset-1);
 } /* finalise_comp */
 
 
-// do the k convolutions, summing results into res.
-void do_convolves(Lfunc *L)
+// let go of a set of G_k transforms
+void free_Ghat(Lfunc *L, Ghat_t *gh)
 {
-  acb_t tmp;
-  arb_t tmp1;
-  acb_init(tmp);
-  arb_init(tmp1);
-  int64_t n, n2, prec=L->wprec;
-  //int64_t n0=round(log(L->M0/Lfu->dc)/(Lf->one_over_B*2*M_PI));
-  int64_t n0=L->low_i;
-  if(verbose)
-    printf("Taking G values from %" PRId64 " to %" PRId64 "\n",n0,L->hi_i);
+  if(!gh)
+    return;
+  if(gh->Gf)
+  {
+    for(uint64_t k=0;k<L->max_K;k++)
+      fixed_vec_clear(gh->Gf+k);
+    free(gh->Gf);
+  }
+  if(gh->G)
+  {
+    for(uint64_t k=0;k<L->max_K;k++)
+      if(gh->G[k])
+      {
+        for(uint64_t n=0;n<L->fft_N;n++)
+          acb_clear(gh->G[k][n]);
+        free(gh->G[k]);
+      }
+    free(gh->G);
+  }
+  free(gh);
+}
+
+typedef struct{
+  Lfunc *L;
+  Ghat_t *gh;
+} Ghat_job_t;
 
-  // let's do k=0
-  //printf("Doing k=%" PRIu64 "\n",0);fflush(stdout);
-  for(n = 0; n < (int64_t)L->fft_N; n++)
-    acb_zero(L->G[n]);
+// put rows lo..hi_i of G_k into G
+static void G_k_vec(acb_t *G, Lfunc *L, uint64_t k, int64_t lo)
+{
+  int64_t n;
+  arb_struct Gv;
+  for(n=0;n<(int64_t)L->fft_N;n++)
+    acb_zero(G[n]);
+  for(n=lo;n<=L->hi_i;n++)
+    arb_set(acb_realref(G[n%L->fft_N]),get_G(&Gv,L,k,n-L->low_i));
+}
 
-  // just copy those G we actually need
-  // i.e. from hi_i down to u_m=round(log(1/sqrt{conductor})*B/2/Pi)
-  // forget that, copy them all
-  for(n=n0,n2=n0-L->low_i;n<=L->hi_i;n++,n2++)
+// with FIXED_CONVOLVE scale G_k to integers in gh->Gf[k] (k=j).
+// otherwise transform G_k into gh->G[k], doing G_2j and G_2j+1
+// together as both are real
+static void Ghat_k(uint64_t j, uint64_t thread, void *arg)
+{
+  Ghat_job_t *gj=(Ghat_job_t *) arg;
+  Lfunc *L=gj->L;
+  (void) thread;
+
+#ifdef FIXED_CONVOLVE
+  acb_t *G=gj->gh->G[j];
+  G_k_vec(G,L,j,gj->gh->lo);
+  fixed_vec_set(gj->gh->Gf+j,G,L->fft_N,L->wprec);
+  for(uint64_t n=0;n<L->fft_N;n++)
+    acb_clear(G[n]);
+  free(G); // only needed on the way
+  gj->gh->G[j]=NULL;
+#else
+  Lthreads_t one={1,-1}; // each transform gets a thread of its own
+  uint64_t k=2*j;
+  G_k_vec(gj->gh->G[k],L,k,gj->gh->lo);
+  if(k+1<L->max_K)
   {
-    int64_t n1=n%L->fft_N;
-    //printf("copying G value ");arb_printd(Lf->Gs[0][n2],20);printf("\n");
-    arb_set(acb_realref(L->G[n1]),L->Gs[0][n2]);
-    //arb_zero(acb_imagref(L->G[n1]));
-  }
-  acb_convolve(L->res,L->skm[0],L->G,L->fft_N,L->w,prec);
-  if ( verbose ) {
-    printf("Convolve 1 out of %" PRId64 " completed.\n",L->max_K);
+    G_k_vec(gj->gh->G[k+1],L,k+1,gj->gh->lo);
+    acb_fft_real2(gj->gh->G[k],gj->gh->G[k+1],L->fft_N,L->w,L->wprec,&one);
   }
-  uint64_t k;
-  for(k=1;k<L->max_K;k++) {
-    for(n=0;n<(int64_t)L->fft_N;n++)
-      acb_zero(L->G[n]);
-    for(n=n0,n2=n0-L->low_i;n<=L->hi_i;n++,n2++) {
-      int64_t n1=n%L->fft_N;
-      arb_set(acb_realref(L->G[n1]),L->Gs[k][n2]);
+  else
+    acb_fft(gj->gh->G[k],L->fft_N,L->w,L->wprec,&one);
+#endif
+}
+
+// the forward transforms of the G_k, holding rows from lo up, from L's
+// family, making them if need be. Rows below offset-1 only reach
+// outputs beyond fft_N/2, which we don't use, but they do change the
+// rounding in the rest, so sets are only shared between Lfuncs asking
+// for the same lo. That way the result depends on L alone and not on
+// what else the family has computed. The rows must already be there
+// (see need_G). Give it back with release_Ghat.
+// returns NULL if we ran out of memory
+Ghat_t *get_Ghat(Lfunc *L, int64_t lo)
+{
+  Lfunc *F=L->family ? L->family : L;
+  if(lo<F->low_i)
+    lo=F->low_i;
+  pthread_mutex_lock(&F->g_lock);
+  Ghat_t *gh=F->Ghat;
+  while(gh&&(gh->lo!=lo))
+    gh=gh->next;
+  if(!gh)
+  {
+    gh=(Ghat_t *)calloc(1,sizeof(Ghat_t));
+    bool ok=gh&&(gh->G=(acb_t **)calloc(F->max_K,sizeof(acb_t *)));
+#ifdef FIXED_CONVOLVE
+    ok=ok&&(gh->Gf=(fixed_vec_t *)malloc(sizeof(fixed_vec_t)*F->max_K));
+    for(uint64_t k=0;ok&&(k<F->max_K);k++)
+      fixed_vec_init(gh->Gf+k);
+#endif
+    for(uint64_t k=0;ok&&(k<F->max_K);k++)
+    {
+      gh->G[k]=(acb_t *)malloc(sizeof(acb_t)*F->fft_N);
+      ok=(gh->G[k]!=NULL);
+      for(uint64_t n=0;ok&&(n<F->fft_N);n++)
+        acb_init(gh->G[k][n]);
+    }
+    if(!ok)
+    {
+      free_Ghat(F,gh);
+      pthread_mutex_unlock(&F->g_lock);
+      return NULL;
     }
-    acb_convolve(L->kres,L->skm[k],L->G,L->fft_N,L->w,prec);
     if(verbose)
-      printf("Convolve %" PRIu64 " out of %" PRId64 " completed.\n",k+1,L->max_K);
+      printf("Transforming G values from %" PRId64 " to %" PRId64 "\n",lo,F->hi_i);
+    gh->lo=lo;
+    Ghat_job_t gj;
+    gj.L=F;
+    gj.gh=gh;
+#ifdef FIXED_CONVOLVE
+    parallel_for(F->max_K,&L->threads,Ghat_k,&gj);
+#else
+    parallel_for((F->max_K+1)/2,&L->threads,Ghat_k,&gj);
+#endif
+    // keep the newest set for the next Lfunc with this lo, anyone
+    // still using the old one will free it when they're done
+    if(F->Ghat&&(F->Ghat->users==0))
+    {
+      Ghat_t *old=F->Ghat;
+      F->Ghat=old->next;
+      free_Ghat(F,old);
+    }
+    gh->next=F->Ghat;
+    F->Ghat=gh;
+  }
+  gh->users++;
+  pthread_mutex_unlock(&F->g_lock);
+  return gh;
+}
 
-    for(n=0; n <= (int64_t)L->fft_N/2; n++)
-      acb_add(L->res[n],L->res[n],L->kres[n],prec);
-    // we need [N-1] to compute epsilon when F_hat(0)=0
-    acb_add(L->res[L->fft_N-1],L->res[L->fft_N-1],L->kres[L->fft_N-1],prec);
+void release_Ghat(Lfunc *L, Ghat_t *gh)
+{
+  Lfunc *F=L->family ? L->family : L;
+  pthread_mutex_lock(&F->g_lock);
+  gh->users--;
+  if((gh->users==0)&&(gh!=F->Ghat))
+  {
+    Ghat_t **p=&F->Ghat;
+    while(*p!=gh)
+      p=&(*p)->next;
+    *p=gh->next;
+    free_Ghat(F,gh);
   }
-  acb_clear(tmp);
-  arb_clear(tmp1);
+  pthread_mutex_unlock(&F->g_lock);
+}
+
+typedef struct{
+  Lfunc *L;
+  Ghat_t *gh; // the transformed G_k
+  bool pairs; // job j does k=2j and 2j+1
+  Lthreads_t fft_threads; // threads to use within each convolution
+  fixed_sum_t *sums; // with FIXED_CONVOLVE, the exact convolutions
+} convolve_job_t;
+
+// convolve skm[k] with G_k, for k=j or, if skm is real and we're doing
+// them in pairs, k=2j,2j+1. With FIXED_CONVOLVE the exact result is
+// left in sums[k], otherwise it is left in skm[k] in the frequency
+// domain. Either way do_convolves sums them and finishes in one go
+void convolve_k(uint64_t j, uint64_t thread, void *arg)
+{
+  convolve_job_t *cj=(convolve_job_t *) arg;
+  Lfunc *L=cj->L;
+  uint64_t k=cj->pairs ? 2*j : j;
+  (void) thread;
+
+#ifdef FIXED_CONVOLVE
+  fixed_vec_t x;
+  fixed_vec_init(&x);
+  fixed_vec_set(&x,L->skm[k],L->fft_N,L->wprec);
+  fixed_convolve(cj->sums+k,&x,cj->gh->Gf+k);
+  fixed_vec_clear(&x);
+#else
+  uint64_t k1=k+1; // the last k we do
+  if(cj->pairs&&(k+1<L->max_K))
+    acb_fft_real2(L->skm[k],L->skm[k+1],L->fft_N,L->w,L->wprec,&cj->fft_threads);
+  else
+  {
+    acb_fft(L->skm[k],L->fft_N,L->w,L->wprec,&cj->fft_threads);
+    k1=k;
+  }
+  for(uint64_t kk=k;kk<=k1;kk++)
+    for(uint64_t n=0;n<L->fft_N;n++)
+      acb_mul(L->skm[kk][n],L->skm[kk][n],cj->gh->G[kk][n],L->wprec);
+#endif
+  if(verbose)
+    printf("Convolve %" PRIu64 " out of %" PRId64 " completed.\n",k+1,L->max_K);
+}
+
+// are all the skm real, e.g. because the coefficients are?
+static bool skm_real(Lfunc *L)
+{
+  for(uint64_t k=0;k<L->max_K;k++)
+    for(uint64_t n=0;n<L->fft_N;n++)
+      if(!arb_is_zero(acb_imagref(L->skm[k][n])))
+        return false;
+  return true;
+}
+
+// do the k convolutions, summing results into res.
+// G_k has been transformed once for the whole family, so each takes
+// one forward FFT (real skm go two to an FFT) and a product. Those are
+// summed and a single inverse FFT turns the sum into the sum of the
+// convolutions. With FIXED_CONVOLVE each is instead one exact integer
+// product (two if skm[k] is complex), and those are summed exactly and
+// rounded once.
+// The convolutions are independent so are
+// shared out between L's threads. The sum is then taken in order of k
+// so the result does not depend on the number of threads.
+Lerror_t do_convolves(Lfunc *L)
+{
+  int64_t prec=L->wprec;
+  convolve_job_t cj;
+  cj.L=L;
+  cj.sums=NULL;
+  cj.gh=get_Ghat(L,L->offset-1);
+  if(!cj.gh)
+    return ERR_OOM;
+
+#ifdef FIXED_CONVOLVE
+  cj.pairs=false; // fixed_convolve spots real skm for itself
+  cj.sums=(fixed_sum_t *)malloc(sizeof(fixed_sum_t)*L->max_K);
+  if(!cj.sums)
+  {
+    release_Ghat(L,cj.gh);
+    return ERR_OOM;
+  }
+  for(uint64_t k=0;k<L->max_K;k++)
+    fixed_sum_init(cj.sums+k,L->fft_N);
+#else
+  cj.pairs=skm_real(L);
+#endif
+  uint64_t n_jobs=cj.pairs ? (L->max_K+1)/2 : L->max_K;
+
+  uint64_t n_threads=L->threads.n_threads;
+  if(n_threads>n_jobs)
+    n_threads=n_jobs;
+  if(n_threads<1)
+    n_threads=1;
+
+  // any threads left over go into the FFTs. These are not pinned as
+  // they would land on CPUs the convolution threads are already using
+  Lthreads_t th=L->threads;
+  th.n_threads=n_threads;
+  cj.fft_threads.n_threads=L->threads.n_threads/n_threads;
+  cj.fft_threads.first_cpu=-1;
+  parallel_for(n_jobs,&th,convolve_k,&cj);
+  release_Ghat(L,cj.gh);
+
+#ifdef FIXED_CONVOLVE
+  for(uint64_t k=1;k<L->max_K;k++)
+    fixed_sum_add(cj.sums,cj.sums+k);
+  fixed_sum_get(L->res,cj.sums,prec);
+  for(uint64_t k=0;k<L->max_K;k++)
+    fixed_sum_clear(cj.sums+k);
+  free(cj.sums);
+#else
+  int64_t n;
+  for(n=0;n<(int64_t)L->fft_N;n++)
+    acb_swap(L->res[n],L->skm[0][n]);
+  // every frequency goes into the inverse transform
+  for(uint64_t k=1;k<L->max_K;k++)
+    for(n=0;n<(int64_t)L->fft_N;n++)
+      acb_add(L->res[n],L->res[n],L->skm[k][n],prec);
+  acb_ifft(L->res,L->fft_N,L->w,prec,&L->threads);
+  for(n=0;n<(int64_t)L->fft_N;n++)
+    acb_div_ui(L->res[n],L->res[n],L->fft_N,prec);
+#endif
+  return ERR_SUCCESS;
 } /* do_convolves */
 
 // handle the coefficients from m=1 to M0-1
@@ -178,6 +403,7 @@ void finish_convolves(Lfunc *L)
   int64_t prec=L->wprec;
   acb_t tmp,tmp2;
   arb_t tmp1,sks;
+  arb_struct Gv;
   acb_init(tmp);acb_init(tmp2);
   arb_init(tmp1);arb_init(sks);
 
@@ -198,7 +424,7 @@ void finish_convolves(Lfunc *L)
       int64_t nn=ms+n;
       if(nn>L->hi_i) // run out of G values
         break;
-      acb_mul_arb(tmp2,L->ans[m],L->Gs[0][nn-L->low_i],prec);
+      acb_mul_arb(tmp2,L->ans[m],get_G(&Gv,L,0,nn-L->low_i),prec);
       //if(n==-1) {printf("adding ");acb_printd(tmp2,20);printf("\n");}
       acb_add(L->res[n%L->fft_N],L->res[n%L->fft_N],tmp2,prec);
     }
@@ -209,7 +435,7 @@ void finish_convolves(Lfunc *L)
       if(nn>L->hi_i) // run out of G values
         break;
       acb_mul_arb(tmp,L->ans[m],sks,prec);
-      acb_mul_arb(tmp2,tmp,L->Gs[1][nn-L->low_i],prec);
+      acb_mul_arb(tmp2,tmp,get_G(&Gv,L,1,nn-L->low_i),prec);
       //if(n==-1) {printf("adding ");acb_printd(tmp2,20);printf("\n");}
       acb_add(L->res[n%L->fft_N],L->res[n%L->fft_N],tmp2,prec);
     }
@@ -224,7 +450,7 @@ void finish_convolves(Lfunc *L)
         int64_t nn=ms+n;
         if(nn>L->hi_i) // run out of G values
           break;
-        acb_mul_arb(tmp2,tmp,L->Gs[k][nn-L->low_i],prec);
+        acb_mul_arb(tmp2,tmp,get_G(&Gv,L,k,nn-L->low_i),prec);
         //if(n==-1) {printf("adding ");acb_printd(tmp2,20);printf("\n");}
         acb_add(L->res[n%L->fft_N],L->res[n%L->fft_N],tmp2,prec);
       }
@@ -259,7 +485,14 @@ void final_ifft(Lfunc *L)
       printf("\n");
     }
   }
-  acb_ifft(L->res,L->fft_NN,L->ww,prec);
+  // copy only wants outputs -a..a and the input is Hermitian (see
+  // do_pre_iFFT_errors), so acb_ifft_hermitian need only transform
+  // res[0..fft_N-1]. at low enough precision double-double is much
+  // quicker and its error bound is just as rigorous.
+  bool dd=(L->wprec<=DD_MAX_PREC);
+  if(!acb_ifft_hermitian(L->res,L->fft_N,L->fft_NN,L->u_no_values_off-1,L->w,L->ww,prec,dd,&L->threads))
+    if((!dd)||!dd_ifft(L->res,L->fft_NN,L->ww))
+      acb_ifft(L->res,L->fft_NN,L->ww,prec,&L->threads);
   if(verbose){printf("iFFT done.\n");fflush(stdout);}
 
   for(uint64_t n=0;n<L->fft_NN;n++)
@@ -269,6 +502,118 @@ void final_ifft(Lfunc *L)
   }
 } /* final_ifft */
 
+// accumulate a_m/sqrt(m)(log(m/sqrt(N))-u_m)^k into skm[k][-u_m] for
+// m=ms[0..n-1] in that order, or m=m0..m0+n-1 if ms is NULL
+void accumulate_skm(acb_t **skm, uint64_t m0, const uint64_t *ms, uint64_t n, Lfunc *L, int64_t prec)
+{
+  arb_t tmp1,sks;
+  acb_t ctmp;
+  arb_init(tmp1);
+  arb_init(sks);
+  acb_init(ctmp);
+  double two_pi_by_B=2.0*M_PI*L->one_over_B;
+
+  for(uint64_t i=0;i<n;i++)
+  {
+    uint64_t m=ms ? ms[i] : m0+i;
+    int64_t u=calc_m(m+1,two_pi_by_B,L->dc);
+    uint64_t b=((uint64_t) -u)%L->fft_N;
+    arb_sqrt_ui(tmp1,m+1,prec);
+    acb_div_arb(L->ans[m],L->ans[m],tmp1,prec);
+    acb_add(skm[0][b],skm[0][b],L->ans[m],prec); // a_m/sqrt(m)(log(m/sqrt(N))-u_m)^0
+    comp_sks(sks,m,u,L,prec);
+    acb_mul_arb(ctmp,L->ans[m],sks,prec);
+    acb_add(skm[1][b],skm[1][b],ctmp,prec); // a_m/sqrt(m)(log(m/sqrt(N))-u_m)^1
+    arb_set(tmp1,sks);
+    for(uint64_t k=2;k<L->max_K;k++)
+    {
+      arb_mul(tmp1,tmp1,sks,prec);
+      acb_mul_arb(ctmp,L->ans[m],tmp1,prec);
+      acb_add(skm[k][b],skm[k][b],ctmp,prec); // a_m/sqrt(m)(log(m/sqrt(N))-u_m)^k
+    }
+  }
+  arb_clear(tmp1);
+  arb_clear(sks);
+  acb_clear(ctmp);
+}
+
+// don't share out an m range shorter than this
+#define SKM_MIN_RANGE (4096)
+
+typedef struct{
+  Lfunc *L;
+  uint64_t *ms; // the m for bin j are ms[start[j]..start[j+1]-1]
+  uint64_t *start;
+} skm_job_t;
+
+void skm_accumulate_job(uint64_t j, uint64_t thread, void *arg)
+{
+  skm_job_t *sj=(skm_job_t *) arg;
+  (void) thread;
+  accumulate_skm(sj->L->skm,0,sj->ms+sj->start[j],sj->start[j+1]-sj->start[j],sj->L,sj->L->wprec);
+}
+
+// add in the terms for m=M0..M into skm and |a_m/sqrt(m)| into sum_ans
+// thread j does the entries skm[k][b] with b=j mod n_bins. Since u_m
+// goes up with m, neighbouring b have about the same number of m so
+// this balances. The m are sorted into their bins first, in order, so
+// each thread only visits its own. Each entry sees exactly the
+// additions, in the same order, as a serial run would, so the balls
+// don't depend on how many threads there are. sum_ans is then added
+// up here in order of m.
+void do_skm(Lfunc *L)
+{
+  int64_t prec=L->wprec;
+  uint64_t m0=L->M0-1,len=L->M-m0;
+  uint64_t n_bins=L->threads.n_threads;
+  if(n_bins>len/SKM_MIN_RANGE)
+    n_bins=len/SKM_MIN_RANGE;
+  skm_job_t sj;
+  sj.L=L;
+  sj.ms=NULL;
+  sj.start=NULL;
+  uint64_t *bins=NULL;
+  if(n_bins>1)
+  {
+    sj.ms=(uint64_t *)malloc(sizeof(uint64_t)*len);
+    sj.start=(uint64_t *)calloc(n_bins+1,sizeof(uint64_t));
+    bins=(uint64_t *)malloc(sizeof(uint64_t)*len);
+  }
+  if(sj.ms&&sj.start&&bins)
+  {
+    double two_pi_by_B=2.0*M_PI*L->one_over_B;
+    for(uint64_t i=0;i<len;i++)
+    {
+      bins[i]=(((uint64_t) -calc_m(m0+i+1,two_pi_by_B,L->dc))%L->fft_N)%n_bins;
+      sj.start[bins[i]+1]++;
+    }
+    for(uint64_t j=0;j<n_bins;j++)
+      sj.start[j+1]+=sj.start[j];
+    // counting sort by bin, keeping the m in order within each
+    for(uint64_t i=0;i<len;i++)
+      sj.ms[sj.start[bins[i]]++]=m0+i;
+    // start[j] now holds where bin j ends, shift back
+    for(uint64_t j=n_bins;j>0;j--)
+      sj.start[j]=sj.start[j-1];
+    sj.start[0]=0;
+    parallel_for(n_bins,&L->threads,skm_accumulate_job,&sj);
+  }
+  else // one bin, or no memory to sort into bins
+    accumulate_skm(L->skm,m0,NULL,len,L,prec);
+  free(sj.ms);
+  free(sj.start);
+  free(bins);
+
+  arb_t tmp;
+  arb_init(tmp);
+  for(uint64_t m=m0;m<L->M;m++)
+  {
+    acb_abs(tmp,L->ans[m],prec);
+    arb_add(L->sum_ans,L->sum_ans,tmp,prec);
+  }
+  arb_clear(tmp);
+}
+
 // this is called by the user to compute all the bits of the Lfunc we expect them to want
 // including Lambda(t) for t =0,1/A,2/A,....
 // the zeros up to height 64/degree
@@ -278,16 +623,11 @@ void final_ifft(Lfunc *L)
 // L^(rank)(1/2)/rank!
 Lerror_t Lfunc_compute(Lfunc_t Lf)
 {
-  static bool init=false;
-  static arb_t tmp1,sks;
-  static acb_t ctmp;
-  if(!init)
-  {
-    init=true;
-    arb_init(tmp1);
-    arb_init(sks);
-    acb_init(ctmp);
-  }
+  arb_t tmp1,sks;
+  acb_t ctmp;
+  arb_init(tmp1);
+  arb_init(sks);
+  acb_init(ctmp);
 
   Lfunc *L=(Lfunc *) Lf;
 
@@ -319,39 +659,27 @@ Lerror_t Lfunc_compute(Lfunc_t Lf)
     for(uint64_t n=0;n<L->fft_N;n++)
       acb_zero(L->skm[k][n]);
 
-  double two_pi_by_B=2.0*M_PI*L->one_over_B;
-
-  for(uint64_t m=L->M0-1;m<L->M;m++)
+  do_skm(L);
+  if(verbose){printf("sum_{n <= %"  PRIu64 " |an/sqrt(n)|=",L->M);arb_printd(L->sum_ans,10);printf("\n");fflush(stdout);}
+  Lerror_t ecode=finalise_comp(L);
+  if(!fatal_error(ecode))
+    ecode|=do_convolves(L);
+  if(fatal_error(ecode))
   {
-    int64_t ms=calc_m(m+1,two_pi_by_B,L->dc);
-    int64_t b=(-ms)%L->fft_N;
-    //arb_set_ui(n,m+1);
-    arb_sqrt_ui(tmp1,m+1,prec);
-    acb_div_arb(L->ans[m],L->ans[m],tmp1,prec);
-    acb_abs(tmp1,L->ans[m],prec);
-    arb_add(L->sum_ans,L->sum_ans,tmp1,prec);
-    //printf("sum |an| now ");arb_printd(L->sum_ans,10);printf("\n");
-    acb_add(L->skm[0][b],L->skm[0][b],L->ans[m],prec); // a_m/sqrt(m)(log(m/sqrt(N))-u_m)^0
-    comp_sks(sks,m,ms,L,prec);
-    //printf("m=%" PRIu64 " sks=",m);arb_printd(sks,20);printf("\n");
-    acb_mul_arb(ctmp,L->ans[m],sks,prec);
-    acb_add(L->skm[1][b],L->skm[1][b],ctmp,prec); // a_m/sqrt(m)(log(m/sqrt(N))-u_m)^1
-    arb_set(tmp1,sks);
-    for(uint64_t k=2;k<L->max_K;k++)
-    {
-      arb_mul(tmp1,tmp1,sks,prec);
-      acb_mul_arb(ctmp,L->ans[m],tmp1,prec);
-      acb_add(L->skm[k][b],L->skm[k][b],ctmp,prec); // a_m/sqrt(m)(log(m/sqrt(N))-u_m)^k
-    }
-    //if( (m + 1) % 100 == 0){printf("sum_{n <= %ld |an/sqrt(n)|=",m+1);arb_printd(L->sum_ans,10);printf("\n");fflush(stdout);}
+    arb_clear(tmp1);
+    arb_clear(sks);
+    acb_clear(ctmp);
+    return ecode;
   }
-  if(verbose){printf("sum_{n <= %"  PRIu64 " |an/sqrt(n)|=",L->M);arb_printd(L->sum_ans,10);printf("\n");fflush(stdout);}
-  finalise_comp(L);
-  do_convolves(L);
   finish_convolves(L);
-  Lerror_t ecode=do_pre_iFFT_errors(L);
+  ecode|=do_pre_iFFT_errors(L);
   if(fatal_error(ecode))
+  {
+    arb_clear(tmp1);
+    arb_clear(sks);
+    acb_clear(ctmp);
     return ecode;
+  }
   final_ifft(L);
 
   if(verbose)
@@ -369,7 +697,12 @@ Lerror_t Lfunc_compute(Lfunc_t Lf)
 #ifdef COMPUTE_RANK
   ecode|=do_rank(L);
   if(fatal_error(ecode))
+  {
+    arb_clear(tmp1);
+    arb_clear(sks);
+    acb_clear(ctmp);
     return ecode;
+  }
 #endif
 
 #ifdef COMPUTE_ZEROS
@@ -380,19 +713,22 @@ Lerror_t Lfunc_compute(Lfunc_t Lf)
   for(int i = 2; i <= L->rank; i++)
     arb_div_ui(L->L_d,L->L_d,i,L->wprec);
 
-  ecode|=find_zeros(L,0);
+  // both sides if we don't know or definately not self dual
+  ecode|=find_all_zeros(L);
   if(fatal_error(ecode))
-    return ecode;
-  if(L->self_dual!=YES) // don't know or definately not
   {
-    ecode|=find_zeros(L,1);
-    if(fatal_error(ecode))
-      return ecode;
+    arb_clear(tmp1);
+    arb_clear(sks);
+    acb_clear(ctmp);
+    return ecode;
   }
 
   ecode|=buthe_check_RH(L);
 #endif
 
+  arb_clear(tmp1);
+  arb_clear(sks);
+  acb_clear(ctmp);
   return ecode;
 
 }
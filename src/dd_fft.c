@@ -0,0 +1,281 @@
+// a double-double version of acb_ifft for when wprec is low enough
+// that it loses nothing. The result is returned as balls whose radii
+// come from a worst case bound carried through every stage.
+//
+// every double-double operation used has relative error at most
+// eps=2^-103 (AccurateDWPlusDW is within 3u^2 and DWTimesDW, FMA
+// version, within 5u^2 for u=2^-53, see Joldes, Muller and Popescu,
+// "Tight and rigorous error bounds for basic building blocks of
+// double-word arithmetic", 2017). A complex product is then within
+// sqrt(2)*gamma_2 <= 2^-100 of the truth relative to |x||w| (Higham,
+// Lemma 3.5), so with twiddles within mu of e(i/n), inputs to a stage
+// within E of their true values and bounded by M, its outputs are
+// within
+//   (2+2mu)E + M*(mu + (1+mu)*2^-99)
+// the input error passing through the twiddle, which may be as big as
+// 1+mu, before it is added.
+// and we add 2^-1060 a stage for anything lost to underflow.
+#include <math.h>
+#include "acb.h"
+#include "inttypes.h"
+#include "glfunc_internals.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+typedef struct{
+  double hi,lo;
+} dd_t;
+
+typedef struct{
+  dd_t re,im;
+} ddc_t;
+
+static inline dd_t fast_two_sum(double a, double b) // |a|>=|b|
+{
+  dd_t r;
+  r.hi=a+b;
+  r.lo=b-(r.hi-a);
+  return r;
+}
+
+static inline dd_t two_sum(double a, double b)
+{
+  dd_t r;
+  r.hi=a+b;
+  double bb=r.hi-a;
+  r.lo=(a-(r.hi-bb))+(b-bb);
+  return r;
+}
+
+// AccurateDWPlusDW
+static inline dd_t dd_add(dd_t x, dd_t y)
+{
+  dd_t s=two_sum(x.hi,y.hi),t=two_sum(x.lo,y.lo);
+  dd_t v=fast_two_sum(s.hi,s.lo+t.hi);
+  return fast_two_sum(v.hi,t.lo+v.lo);
+}
+
+static inline dd_t dd_neg(dd_t x)
+{
+  x.hi=-x.hi;
+  x.lo=-x.lo;
+  return x;
+}
+
+// DWTimesDW with FMA
+static inline dd_t dd_mul(dd_t x, dd_t y)
+{
+  double ch=x.hi*y.hi;
+  double cl1=fma(x.hi,y.hi,-ch);
+  double tl1=fma(x.hi,y.lo,x.lo*y.lo);
+  double cl2=fma(x.lo,y.hi,tl1);
+  return fast_two_sum(ch,cl1+cl2);
+}
+
+static inline ddc_t ddc_add(ddc_t x, ddc_t y)
+{
+  ddc_t r;
+  r.re=dd_add(x.re,y.re);
+  r.im=dd_add(x.im,y.im);
+  return r;
+}
+
+static inline ddc_t ddc_sub(ddc_t x, ddc_t y)
+{
+  ddc_t r;
+  r.re=dd_add(x.re,dd_neg(y.re));
+  r.im=dd_add(x.im,dd_neg(y.im));
+  return r;
+}
+
+static inline ddc_t ddc_mul(ddc_t x, ddc_t y)
+{
+  ddc_t r;
+  r.re=dd_add(dd_mul(x.re,y.re),dd_neg(dd_mul(x.im,y.im)));
+  r.im=dd_add(dd_mul(x.re,y.im),dd_mul(x.im,y.re));
+  return r;
+}
+
+// d = x*2^-s to double-double, adding how far out it is to err
+static void dd_set_arf(dd_t *d, arf_srcptr x, slong s, mag_t err)
+{
+  arf_t t,u;
+  mag_t m;
+  arf_init(t);
+  arf_init(u);
+  mag_init(m);
+  arf_mul_2exp_si(t,x,-s);
+  d->hi=arf_get_d(t,ARF_RND_NEAR);
+  arf_set_d(u,d->hi);
+  arf_sub(t,t,u,ARF_PREC_EXACT,ARF_RND_DOWN);
+  d->lo=arf_get_d(t,ARF_RND_NEAR);
+  arf_set_d(u,d->lo);
+  arf_sub(t,t,u,ARF_PREC_EXACT,ARF_RND_DOWN);
+  arf_get_mag(m,t);
+  mag_add(err,err,m);
+  arf_clear(t);
+  arf_clear(u);
+  mag_clear(m);
+}
+
+// d = x*2^-s, returning a bound on |d-x*2^-s| (radius included)
+static void ddc_set_acb(ddc_t *d, acb_srcptr x, slong s, mag_t err)
+{
+  mag_t r;
+  mag_init(r);
+  mag_add(r,arb_radref(acb_realref(x)),arb_radref(acb_imagref(x)));
+  mag_mul_2exp_si(err,r,-s);
+  dd_set_arf(&d->re,arb_midref(acb_realref(x)),s,err);
+  dd_set_arf(&d->im,arb_midref(acb_imagref(x)),s,err);
+  mag_clear(r);
+}
+
+// r = d*2^s +/- err, exactly
+static void dd_get_arb(arb_t r, dd_t d, slong s, const mag_t err)
+{
+  arf_t u;
+  arf_init(u);
+  arf_set_d(arb_midref(r),d.hi);
+  arf_set_d(u,d.lo);
+  arf_add(arb_midref(r),arb_midref(r),u,ARF_PREC_EXACT,ARF_RND_DOWN);
+  arf_mul_2exp_si(arb_midref(r),arb_midref(r),s);
+  mag_set(arb_radref(r),err);
+  arf_clear(u);
+}
+
+// a bound on max |x[i]|
+static void ddc_max_abs(mag_t res, const ddc_t *x, uint64_t n)
+{
+  double a=0,b=0,c=0,d=0;
+  for(uint64_t i=0;i<n;i++)
+  {
+    a=fmax(a,fabs(x[i].re.hi));
+    b=fmax(b,fabs(x[i].re.lo));
+    c=fmax(c,fabs(x[i].im.hi));
+    d=fmax(d,fabs(x[i].im.lo));
+  }
+  mag_t t;
+  mag_init(t);
+  mag_set_d(res,a);
+  mag_set_d(t,b);
+  mag_add(res,res,t);
+  mag_set_d(t,c);
+  mag_add(res,res,t);
+  mag_set_d(t,d);
+  mag_add(res,res,t);
+  mag_clear(t);
+}
+
+// as acb_ifft(x,n,w,...) but in double-double. returns false (with x
+// untouched) if x won't fit, e.g. has infinite radius.
+bool dd_ifft(acb_t *x, uint64_t n, acb_t *w)
+{
+  mag_t M,E,mu,c,t;
+  mag_init(M);
+  mag_init(E);
+  mag_init(mu);
+  mag_init(c);
+  mag_init(t);
+
+  // scale everything to below 1
+  for(uint64_t i=0;i<n;i++)
+  {
+    acb_get_mag(t,x[i]);
+    mag_max(M,M,t);
+  }
+  if(mag_is_zero(M)||mag_is_inf(M)||COEFF_IS_MPZ(MAG_EXP(M)))
+  {
+    mag_clear(M);mag_clear(E);mag_clear(mu);mag_clear(c);mag_clear(t);
+    return false;
+  }
+  slong s=MAG_EXP(M);
+
+  ddc_t *y=(ddc_t *)malloc(sizeof(ddc_t)*n);
+  ddc_t *ww=(ddc_t *)malloc(sizeof(ddc_t)*n/2);
+  if(!y||!ww)
+  {
+    free(y);
+    free(ww);
+    mag_clear(M);mag_clear(E);mag_clear(mu);mag_clear(c);mag_clear(t);
+    return false;
+  }
+  for(uint64_t i=0;i<n;i++)
+  {
+    ddc_set_acb(y+i,x[i],s,t);
+    mag_max(E,E,t);
+  }
+  for(uint64_t i=0;i<n/2;i++)
+  {
+    ddc_set_acb(ww+i,w[i],0,t);
+    mag_max(mu,mu,t);
+  }
+  // c = mu+(1+mu)*2^-99, see the top of the file
+  mag_one(c);
+  mag_add(c,c,mu);
+  mag_mul_2exp_si(c,c,-99);
+  mag_add(c,c,mu);
+
+  // the same bit reversal and butterflies as acb_fft
+  uint64_t i,j,k,l;
+  for(i=0,l=n>>1;i<l;++i)
+  {
+    for(k=1,j=0;k<n;k<<=1)
+    {
+      j<<=1;
+      if(i&k)
+        j|=1;
+    }
+    ddc_t tmp;
+    if(i<j)
+    {
+      tmp=y[i];y[i]=y[j];y[j]=tmp;
+    }
+    else if(i>j)
+    {
+      tmp=y[n-1-i];y[n-1-i]=y[n-1-j];y[n-1-j]=tmp;
+    }
+    ++i;
+    j|=l;
+    tmp=y[i];y[i]=y[j];y[j]=tmp;
+  }
+  for(k=1;k<n;k<<=1)
+  {
+    ddc_max_abs(M,y,n);
+    l=n/(2*k);
+    for(uint64_t b=0;b<n/2;b++)
+    {
+      ddc_t *p=y+2*k*(b/k)+b%k;
+      ddc_t tmp=ddc_mul(p[k],ww[(b%k)*l]);
+      p[k]=ddc_sub(p[0],tmp);
+      p[0]=ddc_add(p[0],tmp);
+    }
+    mag_one(t);
+    mag_add(t,t,mu);
+    mag_mul(E,E,t);
+    mag_mul_2exp_si(E,E,1);
+    mag_mul(t,M,c);
+    mag_add(E,E,t);
+    mag_set_ui_2exp_si(t,1,-1060);
+    mag_add(E,E,t);
+  }
+
+  // back to balls, scaled up again and with acb_ifft's reordering
+  mag_mul_2exp_si(E,E,s);
+  for(i=0;i<n;i++)
+  {
+    ddc_t *z=y+(n-i)%n;
+    dd_get_arb(acb_realref(x[i]),z->re,s,E);
+    dd_get_arb(acb_imagref(x[i]),z->im,s,E);
+  }
+
+  free(y);
+  free(ww);
+  mag_clear(M);mag_clear(E);mag_clear(mu);mag_clear(c);mag_clear(t);
+  return true;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,219 @@
+// convolutions done as exact integer polynomial products.
+//
+// each vector is scaled to integers sharing one exponent, so that
+// x[n] = (X[n]+e[n])*2^exp with |e[n]|*2^exp <= rad for the real and
+// imaginary parts alike. FLINT then multiplies the integer polynomials
+// exactly and the only error in the result is what rad and rad_g
+// contribute, which is bounded once for the whole vector:
+//   |sum x[n]g[m-n] - sum X[n]G[m-n]2^(exp+exp_g)|
+//     <= rad*sum|G|2^exp_g + rad_g*sum|X|2^exp + N*rad*rad_g
+// the convolutions for each k are then added exactly, shifted to the
+// smallest exponent among them, and the sum is rounded only once with
+// the error terms added up.
+#include <flint/fmpz_poly.h>
+#include "acb.h"
+#include "inttypes.h"
+#include "glfunc_internals.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+void fixed_vec_init(fixed_vec_t *f)
+{
+  fmpz_poly_init(f->re);
+  fmpz_poly_init(f->im);
+  f->exp=0;
+  f->real=false;
+  mag_init(f->rad);
+  mag_init(f->sum_re);
+  mag_init(f->sum_im);
+}
+
+void fixed_vec_clear(fixed_vec_t *f)
+{
+  fmpz_poly_clear(f->re);
+  fmpz_poly_clear(f->im);
+  mag_clear(f->rad);
+  mag_clear(f->sum_re);
+  mag_clear(f->sum_im);
+}
+
+// scale x[0..n-1] to integers of about prec bits
+void fixed_vec_set(fixed_vec_t *f, acb_t *x, uint64_t n, int64_t prec)
+{
+  mag_t m,t;
+  fmpz_t z,s_re,s_im;
+  mag_init(m);
+  mag_init(t);
+  fmpz_init(z);
+  fmpz_init(s_re);
+  fmpz_init(s_im);
+
+  // everything is < 2^MAG_EXP(m)
+  for(uint64_t i=0;i<n;i++)
+  {
+    arb_get_mag(t,acb_realref(x[i]));
+    mag_max(m,m,t);
+    arb_get_mag(t,acb_imagref(x[i]));
+    mag_max(m,m,t);
+  }
+  fmpz_poly_zero(f->re);
+  fmpz_poly_zero(f->im);
+  mag_zero(f->rad);
+  f->real=true;
+  for(uint64_t i=0;f->real&&(i<n);i++)
+    f->real=arb_is_zero(acb_imagref(x[i]));
+  if(mag_is_inf(m)||COEFF_IS_MPZ(MAG_EXP(m))) // nothing worth keeping
+  {
+    f->exp=0;
+    mag_inf(f->rad);
+    mag_inf(f->sum_re);
+    mag_inf(f->sum_im);
+  }
+  else if(mag_is_zero(m)) // all exactly zero, and so is the error
+  {
+    f->exp=0;
+    mag_zero(f->sum_re);
+    mag_zero(f->sum_im);
+  }
+  else
+  {
+    f->exp=MAG_EXP(m)-prec;
+    for(uint64_t i=0;i<n;i++)
+    {
+      arf_get_fmpz_fixed_si(z,arb_midref(acb_realref(x[i])),f->exp);
+      fmpz_poly_set_coeff_fmpz(f->re,i,z);
+      fmpz_abs(z,z);
+      fmpz_add(s_re,s_re,z);
+      arf_get_fmpz_fixed_si(z,arb_midref(acb_imagref(x[i])),f->exp);
+      fmpz_poly_set_coeff_fmpz(f->im,i,z);
+      fmpz_abs(z,z);
+      fmpz_add(s_im,s_im,z);
+      mag_max(f->rad,f->rad,arb_radref(acb_realref(x[i])));
+      mag_max(f->rad,f->rad,arb_radref(acb_imagref(x[i])));
+    }
+    // each mid moved by less than 2^exp getting to an integer
+    mag_set_ui_2exp_si(t,1,f->exp);
+    mag_add(f->rad,f->rad,t);
+    mag_set_fmpz(f->sum_re,s_re);
+    mag_mul_2exp_si(f->sum_re,f->sum_re,f->exp);
+    mag_set_fmpz(f->sum_im,s_im);
+    mag_mul_2exp_si(f->sum_im,f->sum_im,f->exp);
+  }
+
+  mag_clear(m);
+  mag_clear(t);
+  fmpz_clear(z);
+  fmpz_clear(s_re);
+  fmpz_clear(s_im);
+}
+
+void fixed_sum_init(fixed_sum_t *s, uint64_t n)
+{
+  s->re=_fmpz_vec_init(n);
+  s->im=_fmpz_vec_init(n);
+  s->n=n;
+  s->exp=0;
+  s->zero=true;
+  mag_init(s->err_re);
+  mag_init(s->err_im);
+}
+
+void fixed_sum_clear(fixed_sum_t *s)
+{
+  _fmpz_vec_clear(s->re,s->n);
+  _fmpz_vec_clear(s->im,s->n);
+  mag_clear(s->err_re);
+  mag_clear(s->err_im);
+}
+
+// res[m] = sum_n x[n]g[(m-n) mod res->n] exactly, for m=0..res->n-1,
+// where g must be real (its im all zero). If x is real as well so is
+// res, and only one product is needed.
+void fixed_convolve(fixed_sum_t *res, const fixed_vec_t *x, const fixed_vec_t *g)
+{
+  fmpz_poly_t p;
+  mag_t t;
+  fmpz_poly_init(p);
+  mag_init(t);
+  res->exp=x->exp+g->exp;
+
+  for(int part=0;part<2;part++)
+  {
+    fmpz *c=part ? res->im : res->re;
+    mag_ptr err=part ? res->err_im : res->err_re;
+    _fmpz_vec_zero(c,res->n);
+    mag_zero(err);
+    if(part&&x->real)
+      break;
+    // the one error term, see the top of the file
+    mag_mul(err,x->rad,g->sum_re);
+    mag_mul(t,g->rad,part ? x->sum_im : x->sum_re);
+    mag_add(err,err,t);
+    mag_mul(t,x->rad,g->rad);
+    mag_mul_ui(t,t,res->n);
+    mag_add(err,err,t);
+
+    fmpz_poly_mul(p,part ? x->im : x->re,g->re);
+    for(slong j=0;j<fmpz_poly_length(p);j++)
+      fmpz_add(c+j%res->n,c+j%res->n,p->coeffs+j);
+  }
+  res->zero=_fmpz_vec_is_zero(res->re,res->n)&&_fmpz_vec_is_zero(res->im,res->n);
+
+  fmpz_poly_clear(p);
+  mag_clear(t);
+}
+
+// s+=t exactly, both of length s->n
+void fixed_sum_add(fixed_sum_t *s, const fixed_sum_t *t)
+{
+  mag_add(s->err_re,s->err_re,t->err_re);
+  mag_add(s->err_im,s->err_im,t->err_im);
+  if(t->zero)
+    return;
+  if(s->zero)
+  {
+    _fmpz_vec_set(s->re,t->re,s->n);
+    _fmpz_vec_set(s->im,t->im,s->n);
+    s->exp=t->exp;
+    s->zero=false;
+    return;
+  }
+  if(t->exp<s->exp) // bring s down to t's exponent
+  {
+    _fmpz_vec_scalar_mul_2exp(s->re,s->re,s->n,s->exp-t->exp);
+    _fmpz_vec_scalar_mul_2exp(s->im,s->im,s->n,s->exp-t->exp);
+    s->exp=t->exp;
+  }
+  fmpz_t z;
+  fmpz_init(z);
+  for(uint64_t m=0;m<s->n;m++)
+  {
+    fmpz_mul_2exp(z,t->re+m,t->exp-s->exp);
+    fmpz_add(s->re+m,s->re+m,z);
+    fmpz_mul_2exp(z,t->im+m,t->exp-s->exp);
+    fmpz_add(s->im+m,s->im+m,z);
+  }
+  fmpz_clear(z);
+}
+
+// round s to prec, once, into res[0..s->n-1]
+void fixed_sum_get(acb_t *res, const fixed_sum_t *s, int64_t prec)
+{
+  fmpz_t e;
+  fmpz_init(e);
+  fmpz_set_si(e,s->exp);
+  for(uint64_t m=0;m<s->n;m++)
+  {
+    arb_set_round_fmpz_2exp(acb_realref(res[m]),s->re+m,e,prec);
+    arb_add_error_mag(acb_realref(res[m]),s->err_re);
+    arb_set_round_fmpz_2exp(acb_imagref(res[m]),s->im+m,e,prec);
+    arb_add_error_mag(acb_imagref(res[m]),s->err_im);
+  }
+  fmpz_clear(e);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -4,6 +4,10 @@
 #include <string.h>
 #include <math.h>
 #include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <arb_poly.h>
@@ -15,46 +19,12 @@ extern "C"{
 #define maxr MAX_DEGREE
 
 
-  static void printarf(FILE *fp,const arf_t x) {
-    static int init;
-    static fmpz_t m,e;
-
-    if (!init) {
-      fmpz_init(m); fmpz_init(e);
-      init = 1;
-    }
-    arf_get_fmpz_2exp(m,e,x);
-    fmpz_fprint(fp,m); fprintf(fp," "); fmpz_fprint(fp,e);
-  }
-
-  static void printarb(FILE *fp,const arb_t x) {
-    static int init;
-    static arf_t a;
-
-    if (!init) {
-      arf_init(a);
-      init = 1;
-    }
-
-#if 1
-    printarf(fp,arb_midref(x));
-    fprintf(fp," ");
-    arf_set_mag(a,arb_radref(x));
-    printarf(fp,a);
-#else
-    arb_printd(x,15);
-#endif
-  }
 
 
   static void my_hurwitz_zeta(arb_t res,long s,const arb_t a,long prec) {
-    static int init;
-    static arb_t A,t;
+    arb_t A,t;
 
-    if (!init) {
-      arb_init(A); arb_init(t);
-      init = 1;
-    }
+    arb_init(A); arb_init(t);
     arb_set(A,a);
     arb_zero(res);
     while (!arb_is_positive(A)) {
@@ -66,6 +36,7 @@ extern "C"{
     arb_set_si(t,s);
     arb_hurwitz_zeta(t,t,A,prec);
     arb_add(res,res,t,prec);
+    arb_clear(A); arb_clear(t);
   }
 
   // Maclaurin series of log(Gamma_R(s+n/2)/Gamma_R(n/2)),
@@ -74,14 +45,9 @@ extern "C"{
   //   n a non-positive multiple of 4
   static void lgammaR(arb_poly_t res,long r,long n,long prec) {
     long i,m;
-    static int init;
-    static arb_t s,t;
-
-    if (!init) {
-      arb_init(s); arb_init(t);
-      init = 1;
-    }
+    arb_t s,t;
 
+    arb_init(s); arb_init(t);
     arb_poly_zero(res);
     arb_const_pi(s,prec);
     arb_log(s,s,prec);
@@ -112,45 +78,60 @@ extern "C"{
       arb_div_si(s,s,(m&1)?-m:m,prec);
       arb_poly_set_coeff_arb(res,m,s);
     }
+    arb_clear(s); arb_clear(t);
   }
 
   // Polar part of \exp((1/2-s)u)\prod_j\Gamma_\R(s+\mu_j) around s=-n/2
   // returned as a polynomial, with residue in highest degree term
   // returns the order of pole
   // caches each coeff as a poly in u for repeat evaluation
-  static struct {
-    arb_poly_t poly[maxr];
-    long order;
-  } *cache;
-  static long mcache;
-  static long polarpart(arb_poly_t res,long twomu[],long r,long n,
+  // the cache depends only on the mus, so belongs to one run of compute_rows
+  typedef struct {
+    struct {
+      arb_poly_t poly[maxr];
+      long order;
+    } *entries;
+    long mcache;
+  } polar_cache_t;
+
+  static void polar_cache_init(polar_cache_t *pc) {
+    pc->entries = NULL;
+    pc->mcache = 0;
+  }
+
+  static void polar_cache_clear(polar_cache_t *pc) {
+    long i,j;
+    for (i=0;i<pc->mcache;i++)
+      for (j=0;j<maxr;j++)
+        arb_poly_clear(pc->entries[i].poly[j]);
+    free(pc->entries);
+    polar_cache_init(pc);
+  }
+
+  static long polarpart(arb_poly_t res,polar_cache_t *pc,long twomu[],long r,long n,
       arb_srcptr u,long prec) {
     long i,j,k,m;
     arb_ptr p;
-    static int init;
-    static arb_t c,t,pi;
-    static arb_poly_t f,g;
-
-    if (!init) {
-      arb_init(c); arb_init(t); arb_init(pi);
-      arb_poly_init(f); arb_poly_init(g);
-      init = 1;
-    }
+    arb_t c,t,pi;
+    arb_poly_t f,g;
 
+    arb_init(c); arb_init(t);
     arb_poly_zero(res);
-    if (n >= mcache) {
+    if (n >= pc->mcache) {
       k = 2*n;
       if (k < 1024) k = 1024;
-      cache = realloc(cache,k*sizeof(*cache));
-      while (mcache < k) {
-        cache[mcache].order = -1;
+      pc->entries = realloc(pc->entries,k*sizeof(*pc->entries));
+      while (pc->mcache < k) {
+        pc->entries[pc->mcache].order = -1;
         for (j=0;j<maxr;j++)
-          arb_poly_init(cache[mcache].poly[j]);
-        mcache++;
+          arb_poly_init(pc->entries[pc->mcache].poly[j]);
+        pc->mcache++;
       }
-    } else if (cache[n].order >= 0)
+    } else if (pc->entries[n].order >= 0)
       goto computeres;
 
+    arb_init(pi);
+    arb_poly_init(f); arb_poly_init(g);
     m = 0;
     arb_one(c);
     arb_const_pi(pi,prec);
@@ -174,81 +155,79 @@ extern "C"{
         arb_mul(c,c,t,prec);
       }
 
-    cache[n].order = m;
-    if (!m) return 0;
-
-    arb_poly_zero(f);
-    for (j=0;j<r;j++) {
-      lgammaR(g,m-1,twomu[j]-n,prec);
-      arb_poly_add(f,f,g,prec);
-    }
-    arb_poly_exp_series(g,f,m,prec);
-    for (j=0;j<m;j++)
-      if ((p = arb_poly_get_coeff_ptr(g,j)))
-        arb_mul(p,p,c,prec);
-
-    for (i=0;i<m;i++) {
-      arb_poly_zero(cache[n].poly[i]);
-      for (j=0;j<m-i;j++) {
-        arb_poly_get_coeff_arb(t,g,m-(i+1)-j);
-        for (k=j;k>0;k--)
-          arb_div_si(t,t,-k,prec);
-        arb_poly_set_coeff_arb(cache[n].poly[i],j,t);
+    pc->entries[n].order = m;
+    if (m) {
+      arb_poly_zero(f);
+      for (j=0;j<r;j++) {
+        lgammaR(g,m-1,twomu[j]-n,prec);
+        arb_poly_add(f,f,g,prec);
+      }
+      arb_poly_exp_series(g,f,m,prec);
+      for (j=0;j<m;j++)
+        if ((p = arb_poly_get_coeff_ptr(g,j)))
+          arb_mul(p,p,c,prec);
+
+      for (i=0;i<m;i++) {
+        arb_poly_zero(pc->entries[n].poly[i]);
+        for (j=0;j<m-i;j++) {
+          arb_poly_get_coeff_arb(t,g,m-(i+1)-j);
+          for (k=j;k>0;k--)
+            arb_div_si(t,t,-k,prec);
+          arb_poly_set_coeff_arb(pc->entries[n].poly[i],j,t);
+        }
       }
     }
+    arb_clear(pi);
+    arb_poly_clear(f); arb_poly_clear(g);
 
 computeres:
     // scale by exp((n+1)*u/2)
-    arb_mul_si(t,u,n+1,prec);
-    arb_mul_2exp_si(t,t,-1);
-    arb_exp(c,t,prec);
-    for (i=0;i<cache[n].order;i++) {
-      arb_poly_evaluate(t,cache[n].poly[i],u,prec);
+    if (pc->entries[n].order > 0) {
+      arb_mul_si(t,u,n+1,prec);
+      arb_mul_2exp_si(t,t,-1);
+      arb_exp(c,t,prec);
+    }
+    for (i=0;i<pc->entries[n].order;i++) {
+      arb_poly_evaluate(t,pc->entries[n].poly[i],u,prec);
       arb_mul(t,t,c,prec);
-      arb_poly_set_coeff_arb(res,cache[n].order-1-i,t);
+      arb_poly_set_coeff_arb(res,pc->entries[n].order-1-i,t);
     }
-    return cache[n].order;
+    arb_clear(c); arb_clear(t);
+    return pc->entries[n].order;
   }
 
   static void myabs(arb_t y,const arb_t x,long prec) {
-    static int init;
-    static arf_t l,r;
+    arf_t l,r;
 
-    if (!init) {
-      arf_init(l); arf_init(r);
-      init = 1;
-    }
+    arf_init(l); arf_init(r);
     arb_abs(y,x);
     arb_get_interval_arf(l,r,y,prec);
     if (arf_sgn(l) < 0) {
       arf_zero(l);
       arb_set_interval_arf(y,l,r,prec);
     }
+    arf_clear(l); arf_clear(r);
   }
 
   // compute, for l=1,...,r,
   // Res_{s=-n/2}\exp((1/2-s)u)\prod_{j=1}^r\Gamma_\R(s+\mu_j)
   //             * \prod_{j=1}^l(-s-\mu_j)
   // and maximum laurent coeff for each l
-  static void residues(arb_t res[],arb_t maxc[],long twomu[],long r,
+  static void residues(arb_t res[],arb_t maxc[],polar_cache_t *pc,long twomu[],long r,
       long n,arb_srcptr u,long prec) {
     long i,j,m;
-    static int init;
-    static arb_t t;
-    static arb_poly_t f,g;
-
-    if (!init) {
-      arb_init(t);
-      arb_poly_init(f);
-      arb_poly_init(g);
-      init = 1;
-    }
+    arb_t t;
+    arb_poly_t f,g;
 
-    m = polarpart(g,twomu,r,n,u,prec);
+    arb_poly_init(g);
+    m = polarpart(g,pc,twomu,r,n,u,prec);
     if (!m) {
       for (j=0;j<r;j++) arb_zero(res[j]);
+      arb_poly_clear(g);
       return;
     }
+    arb_init(t);
+    arb_poly_init(f);
 
     arb_poly_one(f); arb_poly_neg(f,f);
     arb_poly_shift_left(f,f,1);
@@ -265,26 +244,25 @@ computeres:
       arb_poly_set_coeff_arb(f,0,t);
       arb_poly_mullow(g,g,f,m,prec);
     }
+    arb_clear(t);
+    arb_poly_clear(f);
+    arb_poly_clear(g);
   }
 
   // Taylor polynomial of G around u
-  static void gtaylor(arb_t res[],long twomu[],long r,
+  static void gtaylor(arb_t res[],polar_cache_t *pc,long twomu[],long r,
       arb_srcptr u,long k,long prec,long prec2) {
     long i,j,n;
-    static int init;
-    static arb_t c,t,thresh,temp[maxr],maxc[maxr];
-    static arb_poly_t f,g;
-
-    if (!init) {
-      for (j=0;j<maxr;j++) {
-        arb_init(temp[j]);
-        arb_init(maxc[j]);
-      }
-      arb_init(c); arb_init(t); arb_init(thresh);
-      arb_poly_init(f);
-      arb_poly_init(g);
-      init = 1;
+    arb_t c,t,thresh,temp[maxr],maxc[maxr];
+    arb_poly_t f,g;
+
+    for (j=0;j<r;j++) {
+      arb_init(temp[j]);
+      arb_init(maxc[j]);
     }
+    arb_init(c); arb_init(t); arb_init(thresh);
+    arb_poly_init(f);
+    arb_poly_init(g);
 
     // c = (2*Pi)^r*exp(2*u)
     arb_const_pi(t,prec2);
@@ -301,7 +279,7 @@ computeres:
     for (j=0;j<r;j++)
       arb_zero(res[j]);
     for (n=0;;n++) {
-      residues(temp,maxc,twomu,r,n,u,prec2);
+      residues(temp,maxc,pc,twomu,r,n,u,prec2);
       for (j=0;j<r;j++)
         arb_add(res[j],res[j],temp[j],prec2);
       arb_one(t); arb_mul_2exp_si(t,t,-1);
@@ -352,6 +330,14 @@ computeres:
     }
     for (j=0;j<k;j++)
       arb_trim(res[j],res[j]);
+
+    for (j=0;j<r;j++) {
+      arb_clear(temp[j]);
+      arb_clear(maxc[j]);
+    }
+    arb_clear(c); arb_clear(t); arb_clear(thresh);
+    arb_poly_clear(f);
+    arb_poly_clear(g);
   }
 
   // compute k >= r such that |eps^k*G^{(k)}(u)/k!| < thresh for all u
@@ -359,15 +345,11 @@ computeres:
   static long taylor_terms(arb_t thresh,long twomu[],long r,
       arb_srcptr eps,long prec) {
     long j,k;
-    static int init;
-    static arb_t a,b,t,x,exppi2,four_pir;
+    arb_t a,b,t,x,exppi2,four_pir;
 
-    if (!init) {
-      arb_init(a); arb_init(b);
-      arb_init(t); arb_init(x);
-      arb_init(exppi2); arb_init(four_pir);
-      init = 1;
-    }
+    arb_init(a); arb_init(b);
+    arb_init(t); arb_init(x);
+    arb_init(exppi2); arb_init(four_pir);
     arb_const_pi(t,prec);
     arb_mul_2exp_si(exppi2,t,-1);
     arb_exp(exppi2,exppi2,prec);
@@ -426,6 +408,9 @@ computeres:
     }
 
     arb_set(thresh,x);
+    arb_clear(a); arb_clear(b);
+    arb_clear(t); arb_clear(x);
+    arb_clear(exppi2); arb_clear(four_pir);
     return k;
   }
 
@@ -476,27 +461,64 @@ computeres:
         }
   }
 
-  // compute G data into L
-  // if(op) then also write the data to fp (in the cache dierctory)
-  static void computeall(Lfunc *L, double umin,double Binv,long prec, bool op, FILE *fp) 
+  // what each thread computing rows of G needs for itself
+  typedef struct {
+    polar_cache_t pc;
+    arb_t *g;
+    arb_t u;
+  } g_workspace_t;
+
+  typedef struct {
+    Lfunc *L;
+    g_workspace_t *ws;
+    long *twomu;
+    arb_srcptr eps;
+    arb_ptr g; // the block of rows being computed
+    long lo,k,prec,prec2; // lo is the first row of the block
+  } g_job_t;
+
+  // compute row i=lo+ii of G data, at u=2*i*eps, into g[ii*k..]
+  static void g_row(uint64_t ii, uint64_t thread, void *arg) {
+    g_job_t *gj = (g_job_t *) arg;
+    g_workspace_t *ws = gj->ws+thread;
+    long j, i=gj->lo+(long)ii;
+
+    arb_mul_si(ws->u,gj->eps,2*i,gj->prec2);
+    gtaylor(ws->g,&ws->pc,gj->twomu,gj->L->degree,ws->u,gj->k,gj->prec,gj->prec2);
+    for (j=0;j<gj->k;j++)
+      arb_swap(gj->g+ii*gj->k+j,ws->g[j]);
+  }
+
+  // set eps to pi/B and return the precision the rows of L's table
+  // should use for it
+  static long g_eps(Lfunc *L, arb_t eps)
+  {
+    arb_t pi;
+    double delta = 2*M_PI*L->one_over_B;
+    long prec2 = L->gprec + (long)(exp(2*L->hi_i*delta/L->degree)*M_PI*L->degree/M_LN2) + 100;
+    arb_init(pi);
+    arb_const_pi(pi,prec2); arb_set_d(eps,L->one_over_B); arb_mul(eps,eps,pi,prec2);
+    arb_clear(pi);
+    return prec2;
+  }
+
+  // work out the shape of the G table at precision prec: C, alpha,
+  // 1/B, the range of i, max_K and eq59. These depend only on the mus,
+  // 1/B and prec, so a cached table can be checked against them.
+  static void g_params(Lfunc *L, double umin, double Binv, long prec)
   {
-    long i, j, k, prec2, imin, imax;
+    long i, imin, imax;
     double delta;
-    arb_t *g;
-    arb_t u,eps,thresh;
+    arb_t eps,thresh;
     arf_t m;
     long twomu[maxr];
 
-    arb_init(u); arb_init(eps);
+    arb_init(eps);
     arb_init(thresh); arf_init(m);
 
     for(i = 0; i < (long)L->degree; i++)
       twomu[i]=L->mus[i]*2.0;
 
-    // clear any cached polar parts from last run
-    for (i=0;i<mcache;i++)
-      cache[i].order = -1;
-
     delta = 2*M_PI*Binv;
     arb_one(thresh);
     arb_mul_2exp_si(thresh,thresh,-prec);
@@ -509,221 +531,292 @@ computeres:
     arb_init(L->alpha);
     arb_set_ui(L->alpha,1);
 
-    if(op) {
-      printarf(fp,m);
-      fprintf(fp," 1\n");
-    }
-    prec2 = prec + (long)(exp(2*imax*delta/L->degree)*M_PI*L->degree/M_LN2) + 100;
-    arb_const_pi(u,prec2); arb_set_d(eps,Binv); arb_mul(eps,eps,u,prec2);
-    k = taylor_terms(thresh,twomu,L->degree,eps,prec);
-    L->max_K=k;
     L->one_over_B=Binv;
     if(verbose) printf("1/B set to %f\n",Binv);
     L->low_i=imin;
     L->hi_i=imax;
+    L->gprec=prec;
+    g_eps(L,eps);
+    L->max_K = taylor_terms(thresh,twomu,L->degree,eps,prec);
 
     arb_init(L->eq59);
     arb_set(L->eq59,thresh);
-    if(op) {
-      fprintf(fp,"%.9f %ld %ld\n", Binv, imin, imax);
-      arb_get_abs_ubound_arf(m,thresh,prec);
-      fprintf(fp,"%ld ",k);
-      printarf(fp,m);
-      fprintf(fp,"\n");
-      fflush(fp);
-    }
 
-    L->Gs=(arb_t **)malloc(sizeof(arb_t *)*k);
-    if(!L->Gs)
-    {
-      fprintf(stderr,"Fatal error allocating memory in computeall. Exiting.\n");
-      exit(0);
-    }
-    for(i=0;i<k;i++)
-    {
-      L->Gs[i]=(arb_t *)malloc(sizeof(arb_t)*(imax-imin+1));
-      if(!L->Gs[i])
-      {
-        fprintf(stderr,"Fatal error allocating memory in computeall. Exiting.\n");
-        exit(0);
-      }
-    }
-    for(i=0;i<k;i++)
-      for(j=0;j<=imax-imin;j++)
-        arb_init(L->Gs[i][j]);
+    arb_clear(eps);
+    arb_clear(thresh); arf_clear(m);
+  }
 
+  // compute rows lo..hi of G data into L, whose shape g_params has
+  // already set up. they are done G_BLOCK at a time, working up from the
+  // biggest, and each block's rows are shared out between L's threads,
+  // each with its own cache of polar parts
+  // returns false if we ran out of memory
+  static bool compute_rows(Lfunc *L, long lo, long hi)
+  {
+    long i, k=L->max_K, prec=L->gprec, prec2;
+    long twomu[maxr];
+    arb_t eps;
 
-    g = calloc(k,sizeof(g[0]));
-    for (i=0;i<k;i++)
-      arb_init(g[i]);
-    int64_t ii;
-    for (i=imin,ii=0;i<=imax;i++,ii++) {
-      arb_mul_si(u,eps,2*i,prec2);
-      gtaylor(g,twomu,L->degree,u,k,prec,prec2);
-      for (j=0;j<k;j++) {
-        arb_set(L->Gs[j][ii],g[j]);
-        if( op ) {
-          fprintf(fp, "%ld %ld ", i, j);
-          printarb(fp,g[j]);
-          fprintf(fp,"\n");
-          fflush(fp);
-        }
-      }
+    for(i = 0; i < (long)L->degree; i++)
+      twomu[i]=L->mus[i]*2.0;
+
+    arb_init(eps);
+    prec2 = g_eps(L,eps);
+
+    Lthreads_t th = L->threads;
+    uint64_t t, n_threads = th.n_threads;
+    if (n_threads > (uint64_t)(hi-lo+1)) n_threads = hi-lo+1;
+    if (n_threads > G_BLOCK) n_threads = G_BLOCK;
+    if (n_threads < 1) n_threads = 1;
+    g_job_t gj;
+    slong *exps = (slong *)malloc(sizeof(slong)*k);
+    gj.ws = (g_workspace_t *)malloc(sizeof(g_workspace_t)*n_threads);
+    if (!gj.ws || !exps)
+    {
+      free(gj.ws);
+      free(exps);
+      arb_clear(eps);
+      return false;
     }
+    for (t=0;t<n_threads;t++) {
+      gj.ws[t].g = calloc(k,sizeof(arb_t));
+      if (!gj.ws[t].g)
+        break;
+      // polar parts depend on the mus so start with an empty cache
+      polar_cache_init(&gj.ws[t].pc);
+      for (i=0;i<k;i++)
+        arb_init(gj.ws[t].g[i]);
+      arb_init(gj.ws[t].u);
+    }
+    bool ok = (t == n_threads); // if not, the loop below won't start
+    n_threads = t; // the workspaces to clear
+    gj.L = L;
+    gj.twomu = twomu;
+    gj.eps = eps;
+    gj.g = _arb_vec_init(G_BLOCK*k);
+    gj.k = k;
+    gj.prec = prec;
+    gj.prec2 = prec2;
+    th.n_threads = n_threads;
     for (i=0;i<k;i++)
-      arb_clear(g[i]);
-    free(g);
-    arb_clear(u); arb_clear(eps);
-    arb_clear(thresh); arf_clear(m);
-
+      exps[i] = WORD_MIN;
+    for (gj.lo=lo;ok&&(gj.lo<=hi);gj.lo+=G_BLOCK) {
+      long b_hi = (gj.lo+G_BLOCK-1 < hi) ? gj.lo+G_BLOCK-1 : hi;
+      parallel_for(b_hi-gj.lo+1,&th,g_row,&gj);
+      ok = add_G_rows(L,gj.lo,b_hi,gj.g,exps);
+      if (!ok)
+        drop_G_rows(L,lo,gj.lo-1);
+    }
+
+    for (t=0;t<n_threads;t++) {
+      polar_cache_clear(&gj.ws[t].pc);
+      for (i=0;i<k;i++)
+        arb_clear(gj.ws[t].g[i]);
+      free(gj.ws[t].g);
+      arb_clear(gj.ws[t].u);
+    }
+    free(gj.ws);
+    _arb_vec_clear(gj.g,G_BLOCK*k);
+    free(exps);
+    arb_clear(eps);
+    return ok;
   }
 
   bool read_arb(arb_ptr res, FILE *infile)
   {
-    static bool init=false;
-    static fmpz_t a,b;
-    static mpz_t x,e;
-    static arb_t radius;
-    if(!init)
+    fmpz_t a,b;
+    mpz_t x,e;
+    arb_t radius;
+    bool ok=false;
+    fmpz_init(a);
+    fmpz_init(b);
+    mpz_init(x);
+    mpz_init(e);
+    arb_init(radius);
+
+    if(mpz_inp_str(x,infile,10)&&mpz_inp_str(e,infile,10))
     {
-      init=true;
-      fmpz_init(a);
-      fmpz_init(b);
-      mpz_init(x);
-      mpz_init(e);
-      arb_init(radius);
-    }
-
-
-    if(!mpz_inp_str(x,infile,10))
-      return(false);
-    if(!mpz_inp_str(e,infile,10))
-      return(false);
-    fmpz_set_mpz(a,x);
-    fmpz_set_mpz(b,e);
-    arb_set_fmpz_2exp(res,a,b);
-
-    if(!mpz_inp_str(x,infile,10))
-      return(false);
-    if(!mpz_inp_str(e,infile,10))
-      return(false);
-    fmpz_set_mpz(a,x);
-    fmpz_set_mpz(b,e);
-    arb_set_fmpz_2exp(radius,a,b);
-
-    arb_add_error(res,radius);
-
-    return(true);
+      fmpz_set_mpz(a,x);
+      fmpz_set_mpz(b,e);
+      arb_set_fmpz_2exp(res,a,b);
+
+      if(mpz_inp_str(x,infile,10)&&mpz_inp_str(e,infile,10))
+      {
+        fmpz_set_mpz(a,x);
+        fmpz_set_mpz(b,e);
+        arb_set_fmpz_2exp(radius,a,b);
+        arb_add_error(res,radius);
+        ok=true;
+      }
+    }
+
+    fmpz_clear(a);
+    fmpz_clear(b);
+    mpz_clear(x);
+    mpz_clear(e);
+    arb_clear(radius);
+    return(ok);
   }
 
 
   // each line consists of <i> <k> <m1> <e1> <m2> <e2>
-  // so Gs[i][k]=m1*2^e1 +/- m2*2^e2
+  // so G_k(i)=m1*2^e1 +/- m2*2^e2
   bool read_Gs(FILE *infile, Lfunc *L)
   {
 
     //int64_t prec=L->gprec;
-    int64_t fi, i, j;
-    uint64_t fk;
-
-    for(i=L->low_i,j=0;i<=L->hi_i;i++,j++)
-      for(uint64_t k=0;k<L->max_K;k++)
-      {
-        if(fscanf(infile,"%" PRId64 " %" PRIu64 "", &fi, &fk) != 2)
-          return(false);
-        if(fi!=i)
-          return(false);
-        if(fk!=k)
-          return(false);
-        if(!read_arb(L->Gs[k][j],infile))
-          return(false);
-      }
-    return(true);
+    int64_t fi, i, b, b_hi;
+    uint64_t fk, K=L->max_K;
+    bool ok=true;
+    arb_ptr g=_arb_vec_init(G_BLOCK*K);
+    slong *exps=(slong *)malloc(sizeof(slong)*K);
+    if(!exps)
+      ok=false;
+    for(uint64_t k=0;ok&&(k<K);k++)
+      exps[k]=WORD_MIN;
+
+    // a block of rows at a time, as compute_rows does
+    for(b=L->low_i;ok&&(b<=L->hi_i);b+=G_BLOCK)
+    {
+      b_hi=(b+G_BLOCK-1<L->hi_i) ? b+G_BLOCK-1 : L->hi_i;
+      for(i=b;ok&&(i<=b_hi);i++)
+        for(uint64_t k=0;ok&&(k<K);k++)
+        {
+          ok=(fscanf(infile,"%" PRId64 " %" PRIu64 "", &fi, &fk) == 2)
+            &&(fi==i)&&(fk==k)&&read_arb(g+(i-b)*K+k,infile);
+        }
+      ok=ok&&add_G_rows(L,b,b_hi,g,exps);
+      if(!ok)
+        drop_G_rows(L,L->low_i,b-1);
+    }
+    _arb_vec_clear(g,G_BLOCK*K);
+    free(exps);
+    return(ok);
   }
 
-  // read a file written previously by computeall
-  bool read_gfile(FILE *infile, Lfunc *L)
+  // read a text file written by earlier versions of computeall
+  // returns 1 on success, 0 if it doesn't hold the table g_params has
+  // set up in L and -1 if it is corrupt
+  int read_gfile(FILE *infile, Lfunc *L)
   {
-    int64_t m,e,alpha;
-    //double dalpha;
-    arb_init(L->C);
-    arb_init(L->alpha);
+    int64_t m,e,alpha,low_i,hi_i;
+    uint64_t max_K;
+    double one_over_B;
+    // C, alpha and eq59 as g_params gives them, so only check the shape
     if(fscanf(infile,"%" PRId64 " %" PRId64 " %" PRId64 "\n",&m,&e,&alpha)!=3)
-      return false;
-    arb_set_si(L->C,m);
-    arb_mul_2exp_si(L->C,L->C,e);
-    arb_set_si(L->alpha,alpha);
-    if(fscanf(infile,"%lf %" PRId64 " %" PRId64 "\n",&L->one_over_B,&L->low_i,&L->hi_i)!=3)
-      return false;
-    if(fscanf(infile,"%" PRIu64 "",&L->max_K)!=1)
-      return false;
-
-    fmpz_t a,b;
-    mpz_t x,ee;
-    fmpz_init(a);
-    fmpz_init(b);
+      return -1;
+    if(fscanf(infile,"%lf %" PRId64 " %" PRId64 "\n",&one_over_B,&low_i,&hi_i)!=3)
+      return -1;
+    if(fscanf(infile,"%" PRIu64 "",&max_K)!=1)
+      return -1;
+    if((one_over_B!=L->one_over_B)||(low_i!=L->low_i)||(hi_i!=L->hi_i)||(max_K!=L->max_K))
+      return 0;
+
+    mpz_t x;
     mpz_init(x);
-    mpz_init(ee);
-    arb_init(L->eq59);
-    if(!mpz_inp_str(x,infile,10))
-      return false;
-    if(!mpz_inp_str(ee,infile,10))
-      return false;
-    fmpz_set_mpz(a,x);
-    fmpz_set_mpz(b,ee);
-    arb_set_fmpz_2exp(L->eq59,a,b);
-    fmpz_clear(a);
-    fmpz_clear(b);
+    bool ok=mpz_inp_str(x,infile,10)&&mpz_inp_str(x,infile,10); // eq59
     mpz_clear(x);
-    mpz_clear(ee);
+    if(!ok||!read_Gs(infile,L))
+      return -1;
+    L->g_lo=L->low_i; // we have the lot
+    return 1;
+  }
 
-    L->Gs=(arb_t **)malloc(sizeof(arb_t *)*L->max_K);
-    if(!L->Gs)
-      return false;
-    for(uint64_t k=0;k<L->max_K;k++)
-    {
-      L->Gs[k]=(arb_t *)malloc(sizeof(arb_t)*(L->hi_i-L->low_i+1));
-      if(!L->Gs[k])
-        return false;
-      for(int64_t j=0;j<=L->hi_i-L->low_i;j++)
-        arb_init(L->Gs[k][j]);
-    }
-    return read_Gs(infile,L);
+  // open a new file fname.<pid>.<n> for writing, with the permissions
+  // the caller's umask gives (mkstemp would make it private to us).
+  // returns -1 if we can't.
+  static int open_gcache_temp(char *tname, size_t size, const char *fname)
+  {
+    static unsigned int n_temps = 0;
+    int fd = -1;
+    for(int tries = 0; (fd < 0) && (tries < 100); tries++) {
+      unsigned int n = __atomic_fetch_add(&n_temps, 1, __ATOMIC_RELAXED);
+      snprintf(tname, size, "%s.%ld.%u", fname, (long) getpid(), n);
+      fd = open(tname, O_WRONLY|O_CREAT|O_EXCL, 0666);
+      if( (fd < 0) && (errno != EEXIST) )
+        break; // left over from an earlier run is all we retry for
+    }
+    return fd;
+  }
 
+  // write L's G data to fname in binary. It goes to a temporary file
+  // first which is then renamed, so anyone opening fname sees either
+  // no file or a complete one.
+  static Lerror_t write_gcache(const char *fname, Lfunc *L)
+  {
+    char tname[1400];
+    int fd = open_gcache_temp(tname, sizeof(tname), fname);
+    if( fd < 0 )
+      return ERR_G_OUTFILE; // couldn't open outfile. Not fatal
+    FILE *ofile = fdopen(fd, "wb");
+    if( !ofile ) {
+      close(fd);
+      remove(tname);
+      return ERR_G_OUTFILE;
+    }
+    bool res = write_gfile_bin(ofile, L);
+    if( fclose(ofile) || !res || rename(tname, fname) ) {
+      remove(tname);
+      return ERR_G_OUTFILE;
+    }
+    return ERR_SUCCESS;
   }
 
-  Lerror_t compute_g(Lfunc *L)
+  // take an exclusive lock on fname.lock, waiting if someone else has
+  // it, so that only one process fills in the cache entry fname.
+  // returns the file descriptor to pass to unlock_gcache, or -1 if we
+  // couldn't lock, in which case we just go ahead without.
+  static int lock_gcache(const char *fname)
   {
+    char lname[1400];
+    snprintf(lname, sizeof(lname), "%s.lock", fname);
+    int fd = open(lname, O_RDWR|O_CREAT, 0666);
+    if( fd < 0 )
+      return -1;
+    while( flock(fd, LOCK_EX) )
+      if( errno != EINTR ) {
+        close(fd);
+        return -1;
+      }
+    return fd;
+  }
 
-    Lerror_t ecode=ERR_SUCCESS;
-    bool op = false; // true if we are going to write a cache file
-    FILE *ofile = NULL; // file to write to
+  // the lock file itself is left behind, removing it would let two
+  // processes hold locks on different files of the same name
+  static void unlock_gcache(int fd)
+  {
+    if( fd >= 0 ) {
+      flock(fd, LOCK_UN);
+      close(fd);
+    }
+  }
 
-    // are we in default mode and do we have a cache directory
-    if((L->gprec == 0) && (L->target_prec==DEFAULT_TARGET_PREC) && (L->cache_dir)) {
-      char fname[1337];
-      char fname1[1024] = "";
-      for(uint64_t r=0;r<L->degree;r++)
-        sprintf(fname1, "%s_%.1f", fname1, L->mus[r]);
-      sprintf(fname, "%s/g%s", L->cache_dir, fname1);
-      FILE *infile = fopen(fname, "r");
-      if(infile) // we already have this G file in cache
-      {
-        bool res = read_gfile(infile, L); // so read it
+  // map or failing that read the cache file bname if it holds exactly
+  // the table L wants. returns as read_gfile_bin, or -2 if there's
+  // no such file
+  static int use_gcache(const char *bname, Lfunc *L)
+  {
+    int res = map_gfile_bin(bname, L);
+    if(res == -2) {
+      FILE *infile = fopen(bname, "rb");
+      if(infile) {
+        res = read_gfile_bin(infile, L, L->low_i);
         fclose(infile);
-        if(res) // everything worked
-          return ecode;
-        return ecode|ERR_G_INFILE; // fatal error somewhere
-      }
-      // we don't have this G file in cache
-      ofile = fopen(fname, "w"); // try to open it for writing
-      if( !ofile ) {
-        ecode |= ERR_G_OUTFILE; // couldn't open outfile. Not fatal
-        op = false;
-      } else {
-        op = true; // file open ok so we can output
       }
     }
+    return res;
+  }
+
+  // set up the G data for L, from the cache if it's there.
+  // cache files are named for the mus, 1/B and G precision, and a file
+  // at higher precision than we need will do if there's no exact match.
+  // rows of G are only read or computed once need_G asks for them.
+  Lerror_t compute_g(Lfunc *L)
+  {
+
+    Lerror_t ecode=ERR_SUCCESS;
+    // the old text cache was only ever written for default runs
+    bool default_mode=(L->gprec == 0) && (L->target_prec==DEFAULT_TARGET_PREC);
 
     if( L->gprec == 0) // user hasn't told us what to use
     {
@@ -737,9 +830,112 @@ computeres:
     }
     if(verbose)
       printf("g precision set to %" PRId64 " bits\n", L->gprec);
-    computeall(L, -32*M_LN2, (double)L->degree/512, L->gprec, op, ofile);
-    if(op)
-      fclose(ofile);
+
+    g_params(L, -32*M_LN2, (double)L->degree/512, L->gprec);
+    L->Gs = NULL;
+    L->gmap = NULL;
+    L->g_lo = L->hi_i+1; // no rows yet
+    L->gname = NULL;
+    pthread_mutex_init(&L->g_lock, NULL);
+
+    if(L->cache_dir) {
+      char fname[1337];
+      char fname1[1024] = "";
+      char key[1100];
+      char bname[1341];
+      for(uint64_t r=0;r<L->degree;r++)
+        sprintf(fname1, "%s_%.1f", fname1, L->mus[r]);
+      sprintf(fname, "%s/g%s", L->cache_dir, fname1);
+      sprintf(key, "g%s_B%.10g_p", fname1, L->one_over_B);
+      sprintf(bname, "%s/%s%" PRId64 ".bin", L->cache_dir, key, L->gprec);
+      L->gname = strdup(bname);
+      // if we already have this G file in cache then share it with
+      // anyone else using it, failing that read it
+      int res = use_gcache(bname, L);
+      if(res == 1) // everything worked
+        return ecode;
+      if(res == -1)
+        return ecode|ERR_G_INFILE; // fatal error somewhere
+      // res == 0 means it needs replacing, -2 that there isn't one
+      // so cut down one computed at higher precision if we can
+      char hname[1341];
+      FILE *infile = NULL;
+      if(find_gfile_bin(hname, sizeof(hname), L->cache_dir, key, L->gprec))
+        infile = fopen(hname, "rb");
+      res = 0;
+      if(infile)
+      {
+        res = read_gfile_bin(infile, L, L->low_i);
+        fclose(infile);
+      }
+      else if(default_mode && (infile = fopen(fname, "r"))) // we have it in the old text format
+      {
+        res = read_gfile(infile, L);
+        fclose(infile);
+      }
+      if(res < 0)
+        return ecode|ERR_G_INFILE;
+      if(res > 0) {
+        int lock_fd = lock_gcache(bname);
+        ecode |= write_gcache(bname, L); // so next time is quicker
+        unlock_gcache(lock_fd);
+      }
+      // if we don't have this G file in cache need_G will make it
+    }
+    return ecode;
+  }
+
+  // make sure L holds rows lo..hi_i of G, reading them from the cache
+  // file or computing them (and adding them to the cache) as need be.
+  // the caller must hold L->g_lock or otherwise have L to itself.
+  Lerror_t extend_G(Lfunc *L, int64_t lo)
+  {
+    if(lo < L->low_i)
+      lo = L->low_i;
+    if(lo >= L->g_lo)
+      return ERR_SUCCESS;
+    if(!use_gmap_rows(L, lo))
+      return ERR_G_INFILE;
+    if(lo >= L->g_lo)
+      return ERR_SUCCESS;
+
+    Lerror_t ecode = ERR_SUCCESS;
+    int lock_fd = -1;
+    if(L->gname) {
+      // whoever else is filling in the cache may have these rows,
+      // so wait for them and then take what they made
+      lock_fd = lock_gcache(L->gname);
+      FILE *infile = fopen(L->gname, "rb");
+      if(infile) {
+        read_gfile_bin(infile, L, lo); // if this fails we compute them
+        fclose(infile);
+      }
+    }
+    if(lo < L->g_lo) {
+      if(verbose)
+        printf("Computing G rows %" PRId64 " to %" PRId64 "\n", lo, L->g_lo-1);
+      if(!compute_rows(L, lo, L->g_lo-1)) {
+        unlock_gcache(lock_fd);
+        return ERR_OOM;
+      }
+      L->g_lo = lo;
+      if(L->gname)
+        ecode |= write_gcache(L->gname, L);
+    }
+    unlock_gcache(lock_fd); // let anyone waiting pick them up
+    return ecode;
+  }
+
+  // as extend_G, for an Lfunc that may be sharing its G with others in
+  // its family
+  Lerror_t need_G(Lfunc *L, int64_t lo)
+  {
+    Lfunc *F = L->family ? L->family : L;
+    pthread_mutex_lock(&F->g_lock);
+    Lerror_t ecode = extend_G(F, lo);
+    L->Gs = F->Gs; // these may have been set up just now
+    L->g_lo = F->g_lo;
+    pthread_mutex_unlock(&F->g_lock);
     return ecode;
   }
 
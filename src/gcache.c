@@ -0,0 +1,571 @@
+#include "glfunc.h"
+#include "glfunc_internals.h"
+#include <stdio.h>
+#include <pthread.h>
+#include <string.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+  // binary G cache file layout
+  //   a gcache_header_t
+  //   then for i=low_i..hi_i, for k=0..max_K-1 a record for G_k(i)
+  // a file may hold only the top rows of the table (low_i above the
+  // table's own), the rest being computed as and when needed.
+  //   each record being a gcache_rec_t followed by n_limbs limbs.
+  // a record holds an arb in the same form arb does, so a read only
+  // arb can point straight into a memory mapped file (see get_G).
+  // everything is in the byte order of the machine that wrote it.
+  // C, alpha and eq59 aren't stored, g_params works them out again.
+#define GCACHE_MAGIC "LFUNGBIN"
+#define GCACHE_VERSION (3)
+#define GCACHE_BYTE_ORDER (0x01020304)
+
+  typedef struct{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order; // GCACHE_BYTE_ORDER as written
+    uint64_t limb_bits; // FLINT_BITS as written
+    uint64_t degree;
+    double mus[MAX_DEGREE];
+    int64_t gprec;
+    double one_over_B;
+    int64_t low_i;
+    int64_t hi_i;
+    uint64_t max_K;
+    uint64_t n_limbs; // limbs in every record
+  } gcache_header_t;
+
+  // an arb with mid (-1)^sign*0.limbs*2^exp and rad rad_man*2^(rad_exp-MAG_BITS),
+  // i.e. the mantissa limbs of an arf (least significant first) and a mag
+  typedef struct{
+    int64_t exp;
+    int64_t rad_exp;
+    uint64_t rad_man;
+    uint32_t sign;
+    uint32_t n_used; // limbs of mid actually used, 0 means mid=0
+  } gcache_rec_t;
+
+  static size_t gcache_rec_size(uint64_t n_limbs)
+  {
+    return sizeof(gcache_rec_t)+n_limbs*sizeof(mp_limb_t);
+  }
+
+  // fill in a record from g, false if it won't fit
+  static bool gcache_rec_set(uint8_t *p, arb_srcptr g, uint64_t n_limbs)
+  {
+    gcache_rec_t r;
+    arf_srcptr m=arb_midref(g);
+    mag_srcptr rad=arb_radref(g);
+    if(!arf_is_finite(m)||mag_is_inf(rad)||COEFF_IS_MPZ(MAG_EXP(rad)))
+      return false;
+    memset(p,0,gcache_rec_size(n_limbs));
+    r.sign=0;
+    r.n_used=0;
+    r.exp=0;
+    if(!arf_is_zero(m))
+    {
+      mp_srcptr limbs;
+      mp_size_t n;
+      if(COEFF_IS_MPZ(ARF_EXP(m)))
+        return false;
+      ARF_GET_MPN_READONLY(limbs,n,m);
+      if((uint64_t) n>n_limbs)
+        return false;
+      memcpy(p+sizeof(gcache_rec_t),limbs,n*sizeof(mp_limb_t));
+      r.n_used=n;
+      r.sign=ARF_SGNBIT(m);
+      r.exp=ARF_EXP(m);
+    }
+    r.rad_exp=MAG_EXP(rad);
+    r.rad_man=MAG_MAN(rad);
+    memcpy(p,&r,sizeof(gcache_rec_t));
+    return true;
+  }
+
+  // make view a read only arb for the record at p, which must stay put
+  // for as long as view is used. view must not be written to or cleared.
+  static void gcache_rec_view(arb_struct *view, const uint8_t *p)
+  {
+    gcache_rec_t r;
+    memcpy(&r,p,sizeof(gcache_rec_t));
+    arf_struct *m=arb_midref(view);
+    if(r.n_used==0)
+    {
+      ARF_EXP(m)=ARF_EXP_ZERO;
+      ARF_XSIZE(m)=0;
+    }
+    else
+    {
+      ARF_EXP(m)=r.exp;
+      ARF_XSIZE(m)=ARF_MAKE_XSIZE(r.n_used,r.sign);
+      if(r.n_used<=ARF_NOPTR_LIMBS)
+        memcpy(ARF_NOPTR_D(m),p+sizeof(gcache_rec_t),r.n_used*sizeof(mp_limb_t));
+      else
+      {
+        ARF_PTR_D(m)=(mp_ptr)(p+sizeof(gcache_rec_t));
+        ARF_PTR_ALLOC(m)=r.n_used;
+      }
+    }
+    MAG_EXP(arb_radref(view))=r.rad_exp;
+    MAG_MAN(arb_radref(view))=r.rad_man;
+  }
+
+  // make view a read only arb for G_k(i) in s, as for gcache_rec_view
+  static void gseg_view(arb_struct *view, const gseg_t *s, int64_t i, uint64_t k, uint64_t max_K)
+  {
+    const gent_t *e=s->ents+(i-s->lo)*max_K+k;
+    arf_struct *m=arb_midref(view);
+    if(e->n_used==0)
+    {
+      ARF_EXP(m)=ARF_EXP_ZERO;
+      ARF_XSIZE(m)=0;
+    }
+    else
+    {
+      ARF_EXP(m)=s->exp[k]-e->dexp;
+      ARF_XSIZE(m)=ARF_MAKE_XSIZE(e->n_used,e->sign);
+      if(e->n_used<=ARF_NOPTR_LIMBS)
+        memcpy(ARF_NOPTR_D(m),s->limbs+e->off,e->n_used*sizeof(mp_limb_t));
+      else
+      {
+        ARF_PTR_D(m)=s->limbs+e->off;
+        ARF_PTR_ALLOC(m)=e->n_used;
+      }
+    }
+    *arb_radref(view)=s->rad[k];
+  }
+
+  // G_k(low_i+j) from whichever table L has it in, which must be one of
+  // the rows from g_lo up. The result points into the table via view,
+  // which must not be written to or cleared.
+  arb_srcptr get_G(arb_struct *view, Lfunc *L, uint64_t k, int64_t j)
+  {
+    int64_t i=L->low_i+j;
+    if((!L->gmap)||(i<L->gmap_lo))
+      gseg_view(view,L->Gs[j],i,k,L->max_K);
+    else
+      gcache_rec_view(view,L->grecs+((i-L->gmap_lo)*L->max_K+k)*L->grec_size);
+    return view;
+  }
+
+  // allocate L->Gs for hi_i-low_i+1 rows, none of which we have yet
+  bool alloc_Gs(Lfunc *L)
+  {
+    L->Gs=(gseg_t **)calloc(L->hi_i-L->low_i+1,sizeof(gseg_t *));
+    return L->Gs!=NULL;
+  }
+
+  static void gseg_free(gseg_t *s)
+  {
+    free(s->exp);
+    free(s->rad); // mags with small exponents need no clearing
+    free(s->ents);
+    free(s->limbs);
+    free(s);
+  }
+
+  // add rows lo..hi of G to L's table, G_k(i) being g[(i-lo)*max_K+k].
+  // exps[k] is the largest exponent of G_k seen so far (WORD_MIN if
+  // none) and is updated, so that a run of calls working up from the
+  // biggest values can trim the rest to the same absolute precision.
+  // returns false if we ran out of memory or g won't fit.
+  bool add_G_rows(Lfunc *L, int64_t lo, int64_t hi, arb_srcptr g, slong *exps)
+  {
+    uint64_t K=L->max_K,n=(hi-lo+1)*K;
+    if((!L->Gs)&&!alloc_Gs(L))
+      return false;
+    gseg_t *s=(gseg_t *)calloc(1,sizeof(gseg_t));
+    if(!s)
+      return false;
+    s->lo=lo;
+    s->hi=hi;
+    s->exp=(slong *)malloc(sizeof(slong)*K);
+    s->rad=(mag_struct *)malloc(sizeof(mag_struct)*K);
+    s->ents=(gent_t *)malloc(sizeof(gent_t)*n);
+    if(!s->exp||!s->rad||!s->ents)
+    {
+      gseg_free(s);
+      return false;
+    }
+
+    // find the exponents to trim to and so the most limbs we might need
+    uint64_t n_limbs=0;
+    for(uint64_t k=0;k<K;k++)
+    {
+      for(uint64_t r=k;r<n;r+=K)
+      {
+        arf_srcptr m=arb_midref(g+r);
+        if(!arf_is_finite(m)||mag_is_inf(arb_radref(g+r))||COEFF_IS_MPZ(ARF_EXP(m)))
+        {
+          gseg_free(s);
+          return false;
+        }
+        if(!arf_is_zero(m)&&(ARF_EXP(m)>exps[k]))
+          exps[k]=ARF_EXP(m);
+      }
+      s->exp[k]=exps[k];
+      // a non-zero mid means exps[k] isn't WORD_MIN any more, so only
+      // then is exps[k]-gprec safe to work out
+      for(uint64_t r=k;r<n;r+=K)
+      {
+        if(arf_is_zero(arb_midref(g+r)))
+          continue;
+        slong bits=ARF_EXP(arb_midref(g+r))-(exps[k]-L->gprec);
+        if(bits>0)
+          n_limbs+=(bits+FLINT_BITS-1)/FLINT_BITS;
+      }
+    }
+    if(n_limbs>UINT32_MAX)
+    {
+      gseg_free(s);
+      return false;
+    }
+    s->limbs=(mp_limb_t *)malloc(sizeof(mp_limb_t)*(n_limbs+1));
+    if(!s->limbs)
+    {
+      gseg_free(s);
+      return false;
+    }
+
+    // truncating a mid to absolute precision 2^(exp[k]-gprec) (or to
+    // zero) moves it by less than that, so add that to the radius
+    arf_t t;
+    mag_t err;
+    arf_init(t);
+    mag_init(err);
+    for(uint64_t k=0;k<K;k++)
+      mag_init(s->rad+k);
+    uint64_t off=0;
+    for(uint64_t r=0;r<n;r++)
+    {
+      uint64_t k=r%K;
+      gent_t *e=s->ents+r;
+      arf_srcptr m=arb_midref(g+r);
+      mag_max(s->rad+k,s->rad+k,arb_radref(g+r));
+      e->off=off;
+      e->dexp=0;
+      e->n_used=0;
+      e->sign=0;
+      if(arf_is_zero(m))
+        continue;
+      slong bits=ARF_EXP(m)-(exps[k]-L->gprec);
+      if(bits<=0)
+        continue;
+      arf_set_round(t,m,bits,ARF_RND_DOWN);
+      mp_srcptr d;
+      mp_size_t sz;
+      ARF_GET_MPN_READONLY(d,sz,t);
+      memcpy(s->limbs+off,d,sz*sizeof(mp_limb_t));
+      e->n_used=sz;
+      e->sign=ARF_SGNBIT(t);
+      e->dexp=exps[k]-ARF_EXP(t);
+      off+=sz;
+    }
+    for(uint64_t k=0;k<K;k++)
+      if(exps[k]!=WORD_MIN)
+      {
+        mag_set_ui_2exp_si(err,1,exps[k]-L->gprec);
+        mag_add(s->rad+k,s->rad+k,err);
+      }
+    arf_clear(t);
+    mag_clear(err);
+    mp_limb_t *limbs=(mp_limb_t *)realloc(s->limbs,sizeof(mp_limb_t)*(off+1));
+    if(limbs)
+      s->limbs=limbs;
+
+    for(int64_t i=lo;i<=hi;i++)
+      L->Gs[i-L->low_i]=s;
+    return true;
+  }
+
+  // forget rows lo..hi of L's table, all of whose runs lie within them
+  void drop_G_rows(Lfunc *L, int64_t lo, int64_t hi)
+  {
+    if(!L->Gs)
+      return;
+    for(int64_t i=lo;i<=hi;i++)
+    {
+      gseg_t *s=L->Gs[i-L->low_i];
+      L->Gs[i-L->low_i]=NULL;
+      if(s&&(s->hi==i))
+        gseg_free(s);
+    }
+  }
+
+  // write the G data L holds (rows g_lo to hi_i) to outfile in binary
+  bool write_gfile_bin(FILE *outfile, Lfunc *L)
+  {
+    gcache_header_t h;
+    memset(&h,0,sizeof(gcache_header_t));
+    memcpy(h.magic,GCACHE_MAGIC,8);
+    h.version=GCACHE_VERSION;
+    h.byte_order=GCACHE_BYTE_ORDER;
+    h.limb_bits=FLINT_BITS;
+    h.degree=L->degree;
+    for(uint64_t d=0;d<L->degree;d++)
+      h.mus[d]=L->mus[d];
+    h.gprec=L->gprec;
+    h.one_over_B=L->one_over_B;
+    h.low_i=L->g_lo;
+    h.hi_i=L->hi_i;
+    h.max_K=L->max_K;
+
+    uint64_t j0=L->g_lo-L->low_i,n=L->hi_i-L->low_i+1;
+    arb_struct view;
+    // how many limbs do the longest mantissae need?
+    h.n_limbs=0;
+    for(uint64_t k=0;k<L->max_K;k++)
+      for(uint64_t j=j0;j<n;j++)
+      {
+        arf_srcptr m=arb_midref(get_G(&view,L,k,j));
+        if(ARF_SIZE(m)>(mp_size_t) h.n_limbs)
+          h.n_limbs=ARF_SIZE(m);
+      }
+
+    bool ok=(fwrite(&h,sizeof(gcache_header_t),1,outfile)==1);
+    size_t rec_size=gcache_rec_size(h.n_limbs);
+    uint8_t *row=(uint8_t *)malloc(rec_size*L->max_K);
+    if(!row)
+      ok=false;
+    for(uint64_t j=j0;ok&&(j<n);j++)
+    {
+      for(uint64_t k=0;ok&&(k<L->max_K);k++)
+        ok=gcache_rec_set(row+k*rec_size,get_G(&view,L,k,j),h.n_limbs);
+      if(ok)
+        ok=(fwrite(row,rec_size,L->max_K,outfile)==L->max_K);
+    }
+
+    free(row);
+    return ok&&(fflush(outfile)==0);
+  }
+
+  // check the header h of a cache file of file_size bytes against the
+  // table g_params has set up in L.
+  // returns 1 if it holds (some of the rows of) exactly that table, 2 if
+  // it holds a bigger one at higher precision that can be cut down to
+  // it, 0 if it can't be used (e.g. written by a different version or
+  // machine) and -1 if it is corrupt.
+  static int gcache_use_header(Lfunc *L, const gcache_header_t *h, uint64_t file_size)
+  {
+    if(memcmp(h->magic,GCACHE_MAGIC,8))
+      return -1;
+    if((h->version!=GCACHE_VERSION)||(h->byte_order!=GCACHE_BYTE_ORDER)||(h->limb_bits!=FLINT_BITS))
+      return 0;
+    if(h->degree!=L->degree)
+      return -1;
+    for(uint64_t d=0;d<L->degree;d++)
+      if(h->mus[d]!=L->mus[d])
+        return -1;
+    if((h->hi_i<h->low_i)||(h->max_K==0))
+      return -1;
+    uint64_t n=h->hi_i-h->low_i+1;
+    if(file_size!=sizeof(gcache_header_t)+gcache_rec_size(h->n_limbs)*n*h->max_K)
+      return -1; // truncated or not ours
+
+    if((h->one_over_B!=L->one_over_B)||(h->low_i<L->low_i))
+      return 0;
+    if((h->gprec<L->gprec)||(h->hi_i<L->hi_i)||(h->max_K<L->max_K))
+      return 0;
+    if((h->gprec==L->gprec)&&(h->hi_i==L->hi_i)&&(h->max_K==L->max_K))
+      return 1;
+    return 2;
+  }
+
+  // check every record in the table L is about to use
+  static bool gcache_check_recs(const uint8_t *recs, uint64_t n_recs, uint64_t n_limbs)
+  {
+    size_t rec_size=gcache_rec_size(n_limbs);
+    for(uint64_t r=0;r<n_recs;r++,recs+=rec_size)
+    {
+      gcache_rec_t rec;
+      memcpy(&rec,recs,sizeof(gcache_rec_t));
+      if(rec.n_used>n_limbs)
+        return false;
+      if(rec.n_used&&!(((const mp_limb_t *)(recs+sizeof(gcache_rec_t)))[rec.n_used-1]>>(FLINT_BITS-1)))
+        return false; // arb needs the top bit set
+      if((rec.exp>COEFF_MAX)||(rec.exp<COEFF_MIN)||(rec.rad_exp>COEFF_MAX)||(rec.rad_exp<COEFF_MIN))
+        return false;
+    }
+    return true;
+  }
+
+  // read rows lo and up of the table g_params has set up in L from a file
+  // written by write_gfile_bin into L->Gs, as far as the file has them
+  // and stopping short of those L already holds. L->g_lo says how far
+  // down we got. If the file was written at higher precision only the
+  // terms L needs are read, and add_G_rows trims them to L->gprec.
+  // returns 1 on success, 0 if the file can't be used, -1 if corrupt
+  int read_gfile_bin(FILE *infile, Lfunc *L, int64_t lo)
+  {
+    gcache_header_t h;
+    struct stat st;
+    if(fstat(fileno(infile),&st))
+      return -1;
+    if(fread(&h,sizeof(gcache_header_t),1,infile)!=1)
+      return -1;
+    int res=gcache_use_header(L,&h,st.st_size);
+    if(res<1)
+      return res;
+
+    // rows are stored one after another, so read just the ones we want
+    if(lo<h.low_i)
+      lo=h.low_i;
+    int64_t hi=L->g_lo-1;
+    if(hi>L->hi_i)
+      hi=L->hi_i;
+    if(lo>hi) // nothing we haven't got
+      return 1;
+    uint64_t n=hi-lo+1;
+    size_t rec_size=gcache_rec_size(h.n_limbs);
+    size_t data_size=rec_size*n*h.max_K;
+    uint8_t *data=(uint8_t *)malloc(data_size);
+    arb_struct *views=(arb_struct *)malloc(sizeof(arb_struct)*G_BLOCK*L->max_K);
+    slong *exps=(slong *)malloc(sizeof(slong)*L->max_K);
+    bool ok=data&&views&&exps
+      &&!fseeko(infile,(off_t)(rec_size*(lo-h.low_i)*h.max_K),SEEK_CUR)
+      &&(fread(data,1,data_size,infile)==data_size)
+      &&gcache_check_recs(data,n*h.max_K,h.n_limbs);
+
+    // add_G_rows trims them down to L->gprec
+    for(uint64_t k=0;ok&&(k<L->max_K);k++)
+      exps[k]=WORD_MIN;
+    for(int64_t b=lo;ok&&(b<=hi);b+=G_BLOCK)
+    {
+      int64_t b_hi=(b+G_BLOCK-1<hi) ? b+G_BLOCK-1 : hi;
+      for(int64_t i=b;i<=b_hi;i++)
+        for(uint64_t k=0;k<L->max_K;k++)
+          gcache_rec_view(views+(i-b)*L->max_K+k,data+((i-lo)*h.max_K+k)*rec_size);
+      ok=add_G_rows(L,b,b_hi,views,exps);
+      if(!ok)
+        drop_G_rows(L,lo,b-1);
+    }
+    free(data);
+    free(views);
+    free(exps);
+    if(!ok)
+      return -1;
+    L->g_lo=lo;
+    return 1;
+  }
+
+  // start using the rows of L's mapped file from lo up (as far as it has
+  // them), checking those we haven't used before.
+  // returns false if any of them are corrupt.
+  bool use_gmap_rows(Lfunc *L, int64_t lo)
+  {
+    if(!L->gmap)
+      return true;
+    if(lo<L->gmap_lo)
+      lo=L->gmap_lo;
+    if(lo>=L->g_lo)
+      return true;
+    uint64_t n_limbs=(L->grec_size-sizeof(gcache_rec_t))/sizeof(mp_limb_t);
+    if(!gcache_check_recs(L->grecs+(lo-L->gmap_lo)*L->max_K*L->grec_size,(L->g_lo-lo)*L->max_K,n_limbs))
+      return false;
+    L->g_lo=lo;
+    return true;
+  }
+
+  // attach L to the cache file fname by mapping it read only, so that
+  // all the processes using it share one copy through the page cache.
+  // only a file holding exactly the table g_params set up in L (or the
+  // top rows of it) is mapped. L must not hold any rows yet. The rows
+  // are only checked (and so paged in) by use_gmap_rows as they are
+  // needed.
+  // returns 1 on success, 0 if the file can't be used, -1 if it is
+  // corrupt and -2 if it wasn't mapped (so try read_gfile_bin).
+  int map_gfile_bin(const char *fname, Lfunc *L)
+  {
+    int fd=open(fname,O_RDONLY);
+    if(fd<0)
+      return -2;
+    struct stat st;
+    if(fstat(fd,&st)||((uint64_t) st.st_size<sizeof(gcache_header_t)))
+    {
+      close(fd);
+      return -1;
+    }
+    void *map=mmap(NULL,st.st_size,PROT_READ,MAP_SHARED,fd,0);
+    close(fd); // the mapping keeps its own reference
+    if(map==MAP_FAILED)
+      return -2;
+
+    const uint8_t *base=(const uint8_t *) map;
+    gcache_header_t h;
+    memcpy(&h,base,sizeof(gcache_header_t));
+    int res=gcache_use_header(L,&h,st.st_size);
+    if(res==2)
+      res=-2; // needs cutting down to size
+    if(res!=1)
+    {
+      munmap(map,st.st_size);
+      return res;
+    }
+    L->gmap=base;
+    L->gmap_size=st.st_size;
+    L->gmap_lo=h.low_i;
+    L->grec_size=gcache_rec_size(h.n_limbs);
+    L->grecs=base+sizeof(gcache_header_t);
+    return 1;
+  }
+
+  // look in dir for the cache file with the lowest precision above
+  // prec among those called <key><precision>.bin, putting its name in
+  // fname (of length len).
+  // returns false if there isn't one
+  bool find_gfile_bin(char *fname, size_t len, const char *dir, const char *key, int64_t prec)
+  {
+    DIR *d=opendir(dir);
+    if(!d)
+      return false;
+    size_t key_len=strlen(key);
+    int64_t best=-1;
+    struct dirent *e;
+    while((e=readdir(d)))
+    {
+      int64_t p;
+      int used=0;
+      if(strncmp(e->d_name,key,key_len))
+        continue;
+      if((sscanf(e->d_name+key_len,"%" SCNd64 ".bin%n",&p,&used)!=1)||(e->d_name[key_len+used]!=0)||(used<5))
+        continue;
+      if((p>prec)&&((best<0)||(p<best)))
+        best=p;
+    }
+    closedir(d);
+    if(best<0)
+      return false;
+    return snprintf(fname,len,"%s/%s%" PRId64 ".bin",dir,key,best)<(int) len;
+  }
+
+  // let go of L's G table, whichever sort it is, and what compute_g
+  // set up to extend it
+  void clear_Gs(Lfunc *L)
+  {
+    free(L->gname);
+    L->gname=NULL;
+    pthread_mutex_destroy(&L->g_lock);
+    if(L->gmap)
+    {
+      munmap((void *) L->gmap,L->gmap_size);
+      L->gmap=NULL;
+    }
+    if(L->Gs)
+    {
+      drop_G_rows(L,L->low_i,L->hi_i);
+      free(L->Gs);
+      L->Gs=NULL;
+    }
+  }
+
+#ifdef __cplusplus
+}
+#endif
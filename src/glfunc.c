@@ -1,4 +1,6 @@
 #include "assert.h"
+#include <stddef.h>
+#include <string.h>
 #include "glfunc.h"
 #include "glfunc_internals.h"
 
@@ -88,31 +90,35 @@ int double_comp(const void *a,const void *b)
     return 0;
 }
 
-Lfunc_t Lfunc_init_advanced(Lparams_t *Lp, Lerror_t *ecode)
+// what family_init and Lfunc_fill_gcache both need: the degree, mus,
+// precisions, cache and threads
+static Lfunc *family_basics(Lparams_t *Lp, Lerror_t *ecode)
 {
   ecode[0] = ERR_SUCCESS;
-  uint64_t i,j;
-  arb_t tmp;
+  uint64_t i;
 
   if((Lp->degree<2)||(Lp->degree>MAX_DEGREE)) {
     ecode[0] |= ERR_BAD_DEGREE;
-    return((Lfunc_t) NULL);
+    return NULL;
   }
 
   Lfunc *L=(Lfunc *)malloc(sizeof(Lfunc));
   if(!L)
   {
     ecode[0]|=ERR_OOM;
-    return (Lfunc_t) NULL;
+    return NULL;
   }
+  L->family=NULL;
+  L->owns_family=false;
+  L->Ghat=NULL; // made by the first Lfunc_compute that needs it
   L->degree=Lp->degree;
   L->normalisation=Lp->normalisation;
-  L->conductor=Lp->conductor;
+  L->conductor=1;
   L->mus=(double*)malloc(sizeof(double)*L->degree);
   if(!L->mus)
   {
     ecode[0]|=ERR_OOM;
-    return (Lfunc_t) NULL;
+    return NULL;
   }
   for(i=0;i<L->degree;i++)
   {
@@ -120,7 +126,7 @@ Lfunc_t Lfunc_init_advanced(Lparams_t *Lp, Lerror_t *ecode)
     if(!is_half_int(L->mus[i]))
     {
       ecode[0]|=ERR_MU_HALF;
-      return (Lfunc_t) NULL;
+      return NULL;
     }
   }
 
@@ -145,9 +151,30 @@ Lfunc_t Lfunc_init_advanced(Lparams_t *Lp, Lerror_t *ecode)
   }
   arb_const_pi(L->pi,L->wprec); // set it properly now we know what wprec is
   L->gprec = Lp->gprec;
-  L->self_dual=Lp->self_dual;
-  L->rank=Lp->rank;
+  L->self_dual=DK;
+  L->rank=DK;
   L->cache_dir=Lp->cache_dir;
+  default_threads(&L->threads); // as set by Lfunc_set_threads
+  if(Lp->n_threads)
+    L->threads.n_threads=Lp->n_threads;
+  if(Lp->pin_threads>0)
+    L->threads.first_cpu=Lp->first_cpu;
+  else if(Lp->pin_threads<0)
+    L->threads.first_cpu=-1;
+
+  return L;
+}
+
+// set up the parts of an Lfunc that depend only on the degree, mus and
+// precision. The conductor, self_dual and rank in Lp are not used.
+static Lfunc *family_init(Lparams_t *Lp, Lerror_t *ecode)
+{
+  uint64_t i,j;
+  arb_t tmp;
+
+  Lfunc *L=family_basics(Lp, ecode);
+  if(!L)
+    return NULL;
 
   // See Lemma 2 of M_error1.pdf, Lemma 5 of g.pdf
   // r is always >=2
@@ -155,7 +182,7 @@ Lfunc_t Lfunc_init_advanced(Lparams_t *Lp, Lerror_t *ecode)
   if(!L->nus)
   {
     ecode[0]|=ERR_OOM;
-    return (Lfunc_t) NULL;
+    return NULL;
   }
 
   for(j=0;j<2;j++)
@@ -218,9 +245,10 @@ Lfunc_t Lfunc_init_advanced(Lparams_t *Lp, Lerror_t *ecode)
   arb_clear(tmp1);
   */
 
+
   ecode[0] |= compute_g(L);
   if(fatal_error(ecode[0]))
-    return (Lfunc_t) NULL;
+    return NULL;
   if(verbose)
   {
     printf("eq 5-9 error = ");arb_printd(L->eq59,20);printf("\n");
@@ -251,16 +279,6 @@ Lfunc_t Lfunc_init_advanced(Lparams_t *Lp, Lerror_t *ecode)
   arf_init(L->arf_one_over_A);
   arf_ui_div(L->arf_one_over_A,1,L->arf_A,L->wprec,ARF_RND_NEAR);
 
-  L->G=(acb_t *)malloc(sizeof(acb_t)*L->fft_N);
-  if(!L->G)
-  {
-    arb_clear(tmp);
-    ecode[0]|=ERR_OOM;
-    return (Lfunc_t) NULL;
-  }
-  for(i=0;i<L->fft_N;i++)
-    acb_init(L->G[i]);
-
   L->eta=0.0;
   arb_init(L->delta);
   arb_mul_2exp_si(L->delta,L->pi,-1); // pi/2
@@ -270,37 +288,66 @@ Lfunc_t Lfunc_init_advanced(Lparams_t *Lp, Lerror_t *ecode)
   arb_neg(tmp,L->delta);
   arb_exp(L->exp_delta,tmp,L->wprec);
 
-  L->w=(acb_t *)malloc(sizeof(acb_t)*L->fft_N/2); // twiddles for little FFT
-  if(!L->w)
+  // twiddles for the little and big FFTs, shared with any other Lfunc
+  // that has the same wprec
+  L->w=get_twiddles(L->fft_N,L->wprec);
+  L->ww=get_twiddles(L->fft_NN,L->wprec);
+  if((!L->w)||(!L->ww))
   {
     arb_clear(tmp);
     ecode[0]|=ERR_OOM;
-    return (Lfunc_t) NULL;
+    return NULL;
   }
 
-  for(i=0;i<L->fft_N/2;i++)
-    acb_init(L->w[i]);
-  acb_initfft(L->w,L->fft_N,L->wprec); // set twiddles for little FFT
+  arb_init(L->pre_ftwiddle_error);
+  init_ftwiddle_error(L,L->wprec); // all but the conductor
+
+  arb_clear(tmp);
+  init_buthe(L,L->wprec); // setup stuff for Buthe zero check
+
+  return L;
+}
 
-  L->ww=(acb_t *)malloc(sizeof(acb_t)*L->fft_NN/2); // twiddles for big FFT
-  if(!L->ww)
+// *L=*F but for g_lock, as only the family's one is ever used
+static void copy_family(Lfunc *L, const Lfunc *F)
+{
+  size_t lock_start=offsetof(Lfunc,g_lock),lock_end=lock_start+sizeof(pthread_mutex_t);
+  memcpy(L,F,lock_start);
+  memcpy((char *)L+lock_end,(const char *)F+lock_end,sizeof(Lfunc)-lock_end);
+  memset(&L->g_lock,0,sizeof(pthread_mutex_t));
+}
+
+// set up an Lfunc of the given conductor using the shared parts in F.
+// everything the computation writes to is the new Lfunc's own.
+static Lfunc *instance_init(Lfunc *F, uint64_t conductor, int self_dual, int rank, Lerror_t *ecode)
+{
+  ecode[0] = ERR_SUCCESS;
+  uint64_t i;
+
+  Lfunc *L=(Lfunc *)malloc(sizeof(Lfunc));
+  if(!L)
   {
-    arb_clear(tmp);
     ecode[0]|=ERR_OOM;
-    return (Lfunc_t) NULL;
+    return NULL;
   }
-  for(i=0;i<L->fft_NN/2;i++)
-    acb_init(L->ww[i]);
-  acb_initfft(L->ww,L->fft_NN,L->wprec); // set twiddles for big FFT
+  // read only from here on, so no need for a deep copy. Another member
+  // may be filling in F's G rows, so hold its lock while we look
+  pthread_mutex_lock(&F->g_lock);
+  copy_family(L,F);
+  pthread_mutex_unlock(&F->g_lock);
+  L->family=F;
+  L->owns_family=false;
+  L->conductor=conductor;
+  L->self_dual=self_dual;
+  L->rank=rank;
 
   // space for the zeros once we isolate them
   L->zeros[0]=(arb_t *)malloc(sizeof(arb_t)*MAX_ZEROS);
   L->zeros[1]=(arb_t *)malloc(sizeof(arb_t)*MAX_ZEROS);
   if((!L->zeros[0])||(!L->zeros[1]))
   {
-    arb_clear(tmp);
     ecode[0]|=ERR_OOM;
-    return (Lfunc_t) NULL;
+    return NULL;
   }
   for(i=0;i<MAX_ZEROS;i++)
   {
@@ -308,20 +355,11 @@ Lfunc_t Lfunc_init_advanced(Lparams_t *Lp, Lerror_t *ecode)
     arb_init(L->zeros[1][i]);
   }
 
-  L->kres=(acb_t *)malloc(sizeof(acb_t)*L->fft_N);
-  if(!L->kres)
-  {
-    arb_clear(tmp);
-    ecode[0]|=ERR_OOM;
-    return (Lfunc_t) NULL;
-  }
-
   L->skm=(acb_t **)malloc(sizeof(acb_t *)*L->max_K);
   if(!L->skm)
   {
-    arb_clear(tmp);
     ecode[0]|=ERR_OOM;
-    return (Lfunc_t) NULL;
+    return NULL;
   }
 
   uint64_t k,n;
@@ -330,9 +368,8 @@ Lfunc_t Lfunc_init_advanced(Lparams_t *Lp, Lerror_t *ecode)
     L->skm[k]=(acb_t *)malloc(sizeof(acb_t)*L->fft_N);
     if(!L->skm[k])
     {
-      arb_clear(tmp);
       ecode[0]|=ERR_OOM;
-      return (Lfunc_t) NULL;
+      return NULL;
     }
 
     for(n=0;n<L->fft_N;n++)
@@ -342,20 +379,14 @@ Lfunc_t Lfunc_init_advanced(Lparams_t *Lp, Lerror_t *ecode)
   L->res=(acb_t *)malloc(sizeof(acb_t)*L->fft_NN);
   if(!L->res)
   {
-    arb_clear(tmp);
     ecode[0]|=ERR_OOM;
-    return (Lfunc_t) NULL;
+    return NULL;
   }
 
-  for(n=0;n<L->fft_N;n++)
-    acb_init(L->kres[n]);
   for(n=0;n<L->fft_NN;n++)
     acb_init(L->res[n]);
 
-  arb_init(L->pre_ftwiddle_error);
-  arb_init(L->ftwiddle_error);
-  init_ftwiddle_error(L,L->wprec);
-
+  arb_init(L->ftwiddle_error); // see complete_ftwiddle_error
 
   arb_init(L->one_over_root_N);
   arb_init(L->sum_ans);
@@ -365,31 +396,106 @@ Lfunc_t Lfunc_init_advanced(Lparams_t *Lp, Lerror_t *ecode)
   L->ans = (acb_t *)malloc(sizeof(acb_t)*L->allocated_M);
   if(!L->ans)
   {
-    arb_clear(tmp);
     ecode[0]|=ERR_OOM;
-    return (Lfunc_t) NULL;
+    return NULL;
   }
   for(size_t i = 0; i < L->allocated_M; ++i)
     acb_init(L->ans[i]);
 
-  arb_init(L->ftwiddle_error);
-
-  arb_clear(tmp);
-  init_buthe(L,L->wprec); // setup stuff for Buthe zero check
+  arb_init(L->buthe_Wf);
+  arb_init(L->buthe_Winf);
+  arb_init(L->buthe_Ws);
 
   L->nmax_called=false; // noone has called nmax yet
 
   arb_init(L->Lam_d);
   arb_init(L->L_d);
 
-  ecode[0]|=init_upsampling(L);
+  ecode[0]|=init_upsampling(L); // this depends on the conductor
 
+  return L;
+}
+
+Lerror_t Lfunc_fill_gcache(Lparams_t *Lp)
+{
+  Lerror_t ecode;
+  Lfunc *L=family_basics(Lp, &ecode);
+  if(!L)
+    return ecode;
+  ecode |= compute_g(L); // this sets up C, alpha and eq59 whatever happens
+  if(!fatal_error(ecode))
+    ecode |= extend_G(L, L->low_i); // the whole table, not just what we'd use
+  clear_Gs(L);
+  arb_clear(L->C);
+  arb_clear(L->alpha);
+  arb_clear(L->eq59);
+  arb_clear(L->pi);
+  arb_clear(L->zero_prec);
+  arb_clear(L->zero_error);
+  free(L->mus);
+  free(L);
+  return ecode;
+}
+
+Lfamily_t Lfamily_init_advanced(Lparams_t *Lp, Lerror_t *ecode)
+{
+  return (Lfamily_t) family_init(Lp, ecode);
+}
+
+void Lparams_init(Lparams_t *Lp)
+{
+  Lp->degree=0;
+  Lp->conductor=1;
+  Lp->normalisation=0.0;
+  Lp->mus=NULL;
+  Lp->target_prec = DEFAULT_TARGET_PREC;
+  Lp->rank = DK;
+  Lp->self_dual = DK;
+  Lp->cache_dir = ".";
+  Lp->gprec = 0; // We will try to do something sensible
+  Lp->wprec = 0; // ditto
+  Lp->n_threads = 0; // ditto
+  Lp->pin_threads = 0; // ditto
+  Lp->first_cpu = 0;
+}
+
+Lfamily_t Lfamily_init(uint64_t degree, double normalisation, const double *mus, Lerror_t *ecode)
+{
+  Lparams_t Lp;
+  Lparams_init(&Lp);
+  Lp.degree=degree;
+  Lp.normalisation=normalisation;
+  Lp.mus=(double *)mus;
+
+  return Lfamily_init_advanced(&Lp, ecode);
+}
+
+Lfunc_t Lfunc_init_from_family(Lfamily_t F, uint64_t conductor, int self_dual, int rank, Lerror_t *ecode)
+{
+  return (Lfunc_t) instance_init((Lfunc *) F, conductor, self_dual, rank, ecode);
+}
+
+Lfunc_t Lfunc_init_advanced(Lparams_t *Lp, Lerror_t *ecode)
+{
+  Lfunc *F=family_init(Lp, ecode);
+  if(!F)
+    return (Lfunc_t) NULL;
+  Lerror_t ecode1;
+  Lfunc *L=instance_init(F, Lp->conductor, Lp->self_dual, Lp->rank, &ecode1);
+  ecode[0]|=ecode1;
+  if(!L)
+  {
+    Lfamily_clear((Lfamily_t) F);
+    return (Lfunc_t) NULL;
+  }
+  L->owns_family=true; // so Lfunc_clear will take F with it
   return (Lfunc_t) L;
 }
 
 Lfunc_t Lfunc_init(uint64_t degree, uint64_t conductor, double normalisation, const double *mus, Lerror_t *ecode)
 {
   Lparams_t Lp;
+  Lparams_init(&Lp);
   Lp.degree=degree;
   Lp.conductor=conductor;
   Lp.normalisation=normalisation;
@@ -401,12 +507,6 @@ Lfunc_t Lfunc_init(uint64_t degree, uint64_t conductor, double normalisation, co
   }
   for(size_t i=0; i < degree; ++i)
     Lp.mus[i] = mus[i];
-  Lp.target_prec = DEFAULT_TARGET_PREC;
-  Lp.rank = DK;
-  Lp.self_dual = DK;
-  Lp.cache_dir = ".";
-  Lp.gprec = 0; // We will try to do something sensible
-  Lp.wprec = 0; // ditto
 
   return Lfunc_init_advanced(&Lp, ecode);
 }
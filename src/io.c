@@ -33,22 +33,21 @@ double arb_getd(arb_t x)
 
 double normalised(Lfunc *L, uint64_t side, uint64_t ptr, double t)
 {
-  static bool init=false;
-  static acb_t s;
-  static arb_t tmp1,tmp2;
-  if(!init)
-    {
-      init=true;
-      acb_init(s);
-      arb_init(tmp1);
-      arb_init(tmp2);
-    }
+  acb_t s;
+  arb_t tmp1,tmp2;
+  acb_init(s);
+  arb_init(tmp1);
+  arb_init(tmp2);
 
   arb_set_d(acb_realref(s),0.5);
   arb_set_d(acb_imagref(s),t);
   abs_gamma(tmp1,s,L,100);
   arb_div(tmp2,L->u_values_off[side][ptr],tmp1,100);
-  return arb_getd(tmp2);
+  double res=arb_getd(tmp2);
+  acb_clear(s);
+  arb_clear(tmp1);
+  arb_clear(tmp2);
+  return res;
 }
 
 Lplot_t *Lfunc_plot_data(Lfunc_t LL, uint64_t side, double max_t, uint64_t n_points)
@@ -48,15 +48,10 @@ extern "C"{
   // exp(Pi(r*n/(4*A)-n^2/(A^2*H^2)))
   void exp_term(arb_t res, int64_t n, Lfunc *L, int64_t prec)
   {
-    static bool init=false;
-    static arb_t tmp1, tmp2, tmp3;
-    if(!init)
-    {
-      init=true;
-      arb_init(tmp1);
-      arb_init(tmp2);
-      arb_init(tmp3);
-    }
+    arb_t tmp1, tmp2, tmp3;
+    arb_init(tmp1);
+    arb_init(tmp2);
+    arb_init(tmp3);
     arb_mul_si(tmp1,L->u_one_over_A,n,prec); // n/A
     arb_mul(tmp2,tmp1,tmp1,prec); // n^2/A^2
     arb_mul(tmp3,tmp2,L->u_pi_by_H2,prec); // -Pi n^2/(A^2H^2)
@@ -65,6 +60,9 @@ extern "C"{
     arb_mul_2exp_si(tmp1,tmp1,-2); // Pi r n/(4A)
     arb_add(tmp2,tmp1,tmp3,prec);
     arb_exp(res,tmp2,prec);
+    arb_clear(tmp1);
+    arb_clear(tmp2);
+    arb_clear(tmp3);
   }
 
 
@@ -75,39 +73,6 @@ extern "C"{
    *  (pi A)^d \sum |k| <= H W(k/A) sinc^(d)(-pi k)
   */
   bool df_zero(arb_t res, uint64_t d, Lfunc *L, int64_t prec) {
-    static int64_t init_prec=0;
-    static bool init=false;
-    static arb_t a_pi_d[MAX_L+1], d_bang_pi[MAX_L+1], tmp, tmp1, tmp2, an, term;
-    bool neg_me;
-    if(!init) {
-      init=true;
-      arb_init(tmp);
-      arb_init(tmp1);
-      arb_init(tmp2);
-      arb_init(term);
-      arb_init(an);
-      for(uint64_t i=0;i<=MAX_L;i++) {
-        arb_init(a_pi_d[i]);
-        arb_init(d_bang_pi[i]);
-      }
-    }
-    if(prec > init_prec) { // precision has increased
-      init_prec=prec;
-      // a_pi_d[i] = (pi A)^i
-      arb_set_ui(a_pi_d[0],1);
-      arb_set(a_pi_d[1],L->u_pi_A);
-      for(uint64_t i=2;i<=MAX_L;i++)
-        arb_mul(a_pi_d[i],a_pi_d[i-1],L->u_pi_A,prec);
-      // d_bang_pi[i] = i!/Pi^i
-      arb_set_ui(d_bang_pi[0],1);
-      arb_inv(d_bang_pi[1],L->pi,prec); // 1/Pi
-      for(uint64_t i=2;i<=MAX_L;i++) {
-        // i!/Pi^i = (i-1)!/Pi^(i-1) * i / Pi
-        arb_mul_ui(d_bang_pi[i], d_bang_pi[i-1], i,prec);
-        arb_div(d_bang_pi[i],d_bang_pi[i],L->pi,prec);
-      }
-    }
-
     if(d > MAX_L) {
       printf("Can't compute F^(d)(0) for d>%d.\n",MAX_L);
       return false;
@@ -116,6 +81,28 @@ extern "C"{
       arb_set(res,L->u_values_off[0][0]);
       return true;
     }
+    // these depend on L (via A) so are not cached across calls
+    arb_t a_pi_d, d_bang_pi[MAX_L+1], tmp, tmp1, tmp2, an, term;
+    bool neg_me;
+    arb_init(a_pi_d);
+    arb_init(tmp);
+    arb_init(tmp1);
+    arb_init(tmp2);
+    arb_init(term);
+    arb_init(an);
+    for(uint64_t i=0;i<=d;i++)
+      arb_init(d_bang_pi[i]);
+    // a_pi_d = (pi A)^d
+    arb_pow_ui(a_pi_d,L->u_pi_A,d,prec);
+    // d_bang_pi[i] = i!/Pi^i
+    arb_set_ui(d_bang_pi[0],1);
+    arb_inv(d_bang_pi[1],L->pi,prec); // 1/Pi
+    for(uint64_t i=2;i<=d;i++) {
+      // i!/Pi^i = (i-1)!/Pi^(i-1) * i / Pi
+      arb_mul_ui(d_bang_pi[i], d_bang_pi[i-1], i,prec);
+      arb_div(d_bang_pi[i],d_bang_pi[i],L->pi,prec);
+    }
+
     // do the n=0 term. We know L(1/2)=0
     arb_zero(res);
     for(int64_t n = 1; n <= (int64_t)L->u_N; ++n) {
@@ -186,7 +173,7 @@ extern "C"{
       }
       //printf("{%lld, ", n); arb_printn(term, 100, ARB_STR_NO_RADIUS);printf("}, \n");
       // term = sinc^(d)(-n Pi) * (A pi)^d
-      arb_mul(term, term, a_pi_d[d] ,prec);
+      arb_mul(term, term, a_pi_d ,prec);
 
       for(size_t sign = 0; sign < 2; ++sign) { //
         int64_t k = (sign == 0) ? n : -n;
@@ -217,6 +204,14 @@ extern "C"{
       arb_printd(res, 20);
       printf("\n");
     }
+    arb_clear(a_pi_d);
+    arb_clear(tmp);
+    arb_clear(tmp1);
+    arb_clear(tmp2);
+    arb_clear(term);
+    arb_clear(an);
+    for(uint64_t i=0;i<=d;i++)
+      arb_clear(d_bang_pi[i]);
     return true;
   }
 
@@ -10,22 +10,21 @@ extern "C"{
 
   // find the first point in the left tail for upsampling
   int64_t s_left_n(acb_ptr z, arb_t A, uint64_t prec) {
-    static arb_t tmp,tmp1;
-    static fmpz_t fmpz_tmp;
-    static bool init=false;
-    if(!init)
-    {
-      init=true;
-      arb_init(tmp);
-      arb_init(tmp1);
-      fmpz_init(fmpz_tmp);
-    }
+    arb_t tmp,tmp1;
+    fmpz_t fmpz_tmp;
+    arb_init(tmp);
+    arb_init(tmp1);
+    fmpz_init(fmpz_tmp);
     arb_mul(tmp,acb_realref(z),A,prec);
     arb_get_mid_arb(tmp1,tmp);
     arb_floor(tmp,tmp1,prec);
-    if(arb_get_unique_fmpz(fmpz_tmp,tmp)==0)
-      return BAD_64;
-    return fmpz_get_si(fmpz_tmp); // this is going to be 1st point in left tail
+    int64_t res=BAD_64;
+    if(arb_get_unique_fmpz(fmpz_tmp,tmp))
+      res=fmpz_get_si(fmpz_tmp); // this is going to be 1st point in left tail
+    arb_clear(tmp);
+    arb_clear(tmp1);
+    fmpz_clear(fmpz_tmp);
+    return res;
   }
 
 
@@ -41,16 +40,11 @@ extern "C"{
 
   // compute W(k/A)
   void W_k_A(arb_ptr res, Lfunc *L, int64_t k, int64_t prec, arb_t t0, arb_t pi_by_H2, arb_t A) {
-    static bool init=false;
-    static arb_t tmp,tmp1,tmp2,ka;
-    if(!init)
-    {
-      init=true;
-      arb_init(tmp);
-      arb_init(tmp1);
-      arb_init(tmp2);
-      arb_init(ka);
-    }
+    arb_t tmp,tmp1,tmp2,ka;
+    arb_init(tmp);
+    arb_init(tmp1);
+    arb_init(tmp2);
+    arb_init(ka);
     //printf("t0 = ");arb_printd(t0,20);printf("\n");
     arb_set_si(tmp,k);
     // ka = // k/A
@@ -70,28 +64,29 @@ extern "C"{
     else
       arb_mul(res,L->u_values_off[1][-k],tmp,prec);
     //printf("W(%" PRId64 "/A) = W(",k);arb_printd(ka,20);printf(") = ");;arb_printd(res,20);printf("\n");
+    arb_clear(tmp);
+    arb_clear(tmp1);
+    arb_clear(tmp2);
+    arb_clear(ka);
   }
 
   // W(n/A)sinc(Pi(Az-n))
   Lerror_t s_do_point(acb_ptr res, Lfunc *L, int64_t k, acb_t z, acb_t delta, acb_t sin_delta, arb_t A, int64_t prec, arb_t pi_by_H2)
   {
-    static acb_t tmp,tmp1;
-    static arb_t tmp2;
-    static bool init=false;
-    if(!init)
-    {
-      init=true;
-      acb_init(tmp);
-      acb_init(tmp1);
-      arb_init(tmp2);
-    }
+    acb_t tmp;
+    arb_t tmp2;
+    acb_init(tmp);
+    arb_init(tmp2);
 
     Lerror_t ecode=s_sinc(tmp,delta,sin_delta,prec);
-    if(fatal_error(ecode))
-      return ecode;
-    //printf("s_sinc returned ");acb_printd(tmp,20);printf("\n");
-    W_k_A(tmp2,L,k,prec,acb_realref(z),pi_by_H2,A);
-    acb_mul_arb(res,tmp,tmp2,prec);
+    if(!fatal_error(ecode))
+    {
+      //printf("s_sinc returned ");acb_printd(tmp,20);printf("\n");
+      W_k_A(tmp2,L,k,prec,acb_realref(z),pi_by_H2,A);
+      acb_mul_arb(res,tmp,tmp2,prec);
+    }
+    acb_clear(tmp);
+    arb_clear(tmp2);
     return ecode;
     //printf("W(%" PRId64 "/A)sinc(Pi(Az-(%" PRId64 "))) = ",k,k);acb_printd(res,20);printf("\n");
   }
@@ -99,25 +94,20 @@ extern "C"{
   // estimate W(1/2+iz) by upsampling off Lu->u_values_off
   Lerror_t s_upsample_stride(acb_ptr res, acb_ptr z, Lfunc *L, int64_t prec, arb_t pi_by_H2, arb_t err, int64_t N, uint64_t stride)
   {
-    static arb_t A; // the A for upsampling = usual A / stride
-    static acb_t diff,this_diff,term,sin_diff,neg_sin_diff;
-    static bool init=false;
-    if(!init)
-    {
-      init=true;
-      arb_init(A);
-      acb_init(diff);
-      acb_init(this_diff);
-      acb_init(term);
-      acb_init(sin_diff);
-      acb_init(neg_sin_diff);
-    }
-    //printf("-Pi/h^2 = ");arb_printd(pi_by_H2,20);printf("\n");
-    arb_div_ui(A,L->arb_A,stride,prec);
-    //printf("Special point upsampling A set to ");arb_printd(A,20);printf("\n");
     int64_t n=s_left_n(z,L->arb_A,prec);
     if(n==BAD_64)
       return ERR_SPEC_VALUE;
+    arb_t A; // the A for upsampling = usual A / stride
+    acb_t diff,this_diff,term,sin_diff,neg_sin_diff;
+    arb_init(A);
+    acb_init(diff);
+    acb_init(this_diff);
+    acb_init(term);
+    acb_init(sin_diff);
+    acb_init(neg_sin_diff);
+    //printf("-Pi/h^2 = ");arb_printd(pi_by_H2,20);printf("\n");
+    arb_div_ui(A,L->arb_A,stride,prec);
+    //printf("Special point upsampling A set to ");arb_printd(A,20);printf("\n");
     acb_mul_arb(diff,z,A,prec);
     acb_sub_ui(diff,diff,n,prec);
     acb_mul_arb(diff,diff,L->pi,prec);
@@ -129,42 +119,55 @@ extern "C"{
 
     // do nearest point
     Lerror_t ecode=s_do_point(res,L,n,z,diff,sin_diff,L->arb_A,prec,pi_by_H2);
-    if(fatal_error(ecode))
-      return ecode;
-    if(verbose){printf("Nearest point contributed ");acb_printd(res,20);printf("\n");}
-    acb_set(this_diff,diff);
-    // do Lu->N points to left of left
-    for(uint64_t count=0; count < (uint64_t)N; count++)
+    if(!fatal_error(ecode))
     {
-      acb_add_arb(this_diff,this_diff,L->pi,prec);
-      nn-=stride;
-      if(count&1)
-        ecode |= s_do_point(term,L,nn,z,this_diff,sin_diff,L->arb_A,prec,pi_by_H2);
-      else
-        ecode |= s_do_point(term,L,nn,z,this_diff,neg_sin_diff,L->arb_A,prec,pi_by_H2);
-      if(fatal_error(ecode))
-        return ecode;
-      acb_add(res,res,term,prec);
+      if(verbose){printf("Nearest point contributed ");acb_printd(res,20);printf("\n");}
+      acb_set(this_diff,diff);
+      // do Lu->N points to left of left
+      for(uint64_t count=0; count < (uint64_t)N; count++)
+      {
+        acb_add_arb(this_diff,this_diff,L->pi,prec);
+        nn-=stride;
+        if(count&1)
+          ecode |= s_do_point(term,L,nn,z,this_diff,sin_diff,L->arb_A,prec,pi_by_H2);
+        else
+          ecode |= s_do_point(term,L,nn,z,this_diff,neg_sin_diff,L->arb_A,prec,pi_by_H2);
+        if(fatal_error(ecode))
+          break;
+        acb_add(res,res,term,prec);
+      }
     }
 
-    acb_set(this_diff,diff);
-    nn=n;
+    if(!fatal_error(ecode))
+    {
+      acb_set(this_diff,diff);
+      nn=n;
 
-    // do N points to right of left
-    for(uint64_t count = 0; count < (uint64_t)N; count++)
+      // do N points to right of left
+      for(uint64_t count = 0; count < (uint64_t)N; count++)
+      {
+        acb_sub_arb(this_diff,this_diff,L->pi,prec);
+        nn+=stride;
+        if(count&1)
+          ecode|=s_do_point(term,L,nn,z,this_diff,sin_diff,L->arb_A,prec,pi_by_H2);
+        else
+          ecode|=s_do_point(term,L,nn,z,this_diff,neg_sin_diff,L->arb_A,prec,pi_by_H2);
+        if(fatal_error(ecode))
+          break;
+        acb_add(res,res,term,prec);
+      }
+    }
+    if(!fatal_error(ecode))
     {
-      acb_sub_arb(this_diff,this_diff,L->pi,prec);
-      nn+=stride;
-      if(count&1)
-        ecode|=s_do_point(term,L,nn,z,this_diff,sin_diff,L->arb_A,prec,pi_by_H2);
-      else
-        ecode|=s_do_point(term,L,nn,z,this_diff,neg_sin_diff,L->arb_A,prec,pi_by_H2);
-      if(fatal_error(ecode))
-        return ecode;
-      acb_add(res,res,term,prec);
+      arb_add_error(acb_realref(res),err);
+      arb_add_error(acb_imagref(res),err);
     }
-    arb_add_error(acb_realref(res),err);
-    arb_add_error(acb_imagref(res),err);
+    arb_clear(A);
+    acb_clear(diff);
+    acb_clear(this_diff);
+    acb_clear(term);
+    acb_clear(sin_diff);
+    acb_clear(neg_sin_diff);
     return ecode;
   }
 
@@ -229,122 +232,146 @@ extern "C"{
     arb_clear(tmp);
   }
 
-  // compute L(s) into res where s is given in algebraic normalisation
-  Lerror_t Lfunc_special_value(acb_t res, Lfunc_t LL, double alg_res, double alg_ims)
-  {
-    double T=alg_ims;
-    if (verbose) printf("T set to %f\n",T);
-    if(T<0.0)
-      return ERR_SPEC_NZ; // need s in upper half plane
-    
-    Lerror_t ecode=ERR_SUCCESS;
-    Lfunc *L=(Lfunc *) LL;
-    int64_t prec=L->wprec;
-    //printf("Algebraic s = %f + i%f\n",alg_res,alg_ims);
+#define SPEC_STRIDE (32) // should be computed dynamically
 
-    arb_t arb_err,tmp;
-    acb_t an_s; // analytic version of s
-    acb_init(an_s);
-    arb_init(arb_err);
+  // the upsampling parameters chosen for one special value
+  typedef struct{
+    double h;
+    uint64_t H;
+    arb_t err;
+  } s_params_t;
+
+  // set an_s (analytic s) and z from s in algebraic normalisation
+  void s_setup(acb_t an_s, acb_t z, Lfunc *L, double alg_res, double alg_ims, int64_t prec)
+  {
+    arb_t tmp;
     arb_init(tmp);
     arb_set_d(tmp, L->normalisation);
-    arb_set_d(arb_err, alg_res);
-    arb_sub(acb_realref(an_s),arb_err,tmp,prec); // an re(s) = alg re(s)- norm
+    arb_set_d(acb_realref(an_s), alg_res);
+    arb_sub(acb_realref(an_s),acb_realref(an_s),tmp,prec); // an re(s) = alg re(s)- norm
     arb_set_d(acb_imagref(an_s),alg_ims);
     //printf("Analytic s = ");acb_printd(an_s,20);printf("\n");
-    
-    acb_t z;
-    acb_init(z);
     arb_set(acb_realref(z),acb_imagref(an_s));
     arb_set_d(tmp,0.5);
     arb_sub(acb_imagref(z),tmp,acb_realref(an_s),prec);
-    if(verbose) {printf("special value z = ");acb_printd(z,20);printf("\n");}    
-    uint64_t stride=32; // should be computed dynamically
-    double A=L->A/(double)stride;
+    if(verbose) {printf("special value z = ");acb_printd(z,20);printf("\n");}
+    arb_clear(tmp);
+  }
 
-    double h=sqrt(1.0/A)*1.001,best_h=h;
-    double H=ceil(A*A*h*h/2.0),best_H=H;
-    double M=H/A;
-    double dimz=0.5-(alg_res - L->normalisation); // double approx to Im z
+  // does err get us to target_prec at Im z = dimz?
+  bool s_err_ok(arb_t err, Lfunc *L, double h, double A, double dimz, int64_t prec)
+  {
+    arb_t tmp;
+    arb_init(tmp);
+    int64_t extra_bits=(int64_t)(M_PI*(dimz*dimz/(h*h)+fabs(dimz)*A)/M_LN2)+10;
+    if(verbose)
+    {
+      printf("h=%f extra_bits=%" PRId64 "\n", h, extra_bits);
+      printf("arb_error now ");arb_printd(err,20);printf("\n");
+    }
+    arb_mul_2exp_si(tmp,err,L->target_prec+extra_bits);
+    arb_sub_ui(tmp,tmp,1,prec);
+    bool res=arb_is_negative(tmp);
+    arb_clear(tmp);
+    return res;
+  }
+
+  // choose h and H for upsampling to z = T + i dimz.
+  // if try_h>0 see if that h will do before searching
+  Lerror_t s_choose_params(s_params_t *sp, Lfunc *L, double T, double dimz, acb_t z, double try_h, int64_t prec)
+  {
+    double A=L->A/(double)SPEC_STRIDE;
+    double h,H,M;
+    Lerror_t ecode=ERR_SUCCESS;
+
+    if(try_h>0.0)
+    {
+      h=try_h;
+      H=ceil(A*A*h*h/2.0);
+      if(H*SPEC_STRIDE<=L->u_no_values_off)
+      {
+        M=H/A;
+        ecode|=arb_upsampling_error(sp->err,M,H,h,A,L->mus,L->degree,L->conductor,T,acb_imagref(z),0,L->pi,prec);
+        if(fatal_error(ecode))
+          return ecode;
+        if(s_err_ok(sp->err,L,h,A,dimz,prec))
+        {
+          sp->h=h;
+          sp->H=H;
+          return ecode;
+        }
+      }
+    }
+
+    h=sqrt(1.0/A)*1.001;
+    double best_h=h;
+    H=ceil(A*A*h*h/2.0);
+    double best_H=H;
+    M=H/A;
     if(verbose) printf("A = %f Im z = %f\n",A,dimz);
-    ecode|=arb_upsampling_error(arb_err,M,H,h,A,L->mus,L->degree,L->conductor,T,acb_imagref(z),0,L->pi,prec); // first effort
+    ecode|=arb_upsampling_error(sp->err,M,H,h,A,L->mus,L->degree,L->conductor,T,acb_imagref(z),0,L->pi,prec); // first effort
     if(fatal_error(ecode))
-    {
-      arb_clear(tmp);
-      acb_clear(z);
-      acb_clear(an_s);
-      arb_clear(arb_err);
       return ecode;
-    }
 
-    arb_t best_err;
+    arb_t best_err,tmp;
     arb_init(best_err);
-    arb_set(best_err,arb_err);
+    arb_init(tmp);
+    arb_set(best_err,sp->err);
     while(true)
     {
-      int64_t extra_bits=(int64_t)(M_PI*(dimz*dimz/(h*h)+fabs(dimz)*A)/M_LN2)+10;
-      if(verbose)
-      {
-        printf("h=%f extra_bits=%" PRId64 "\n", h, extra_bits);
-        printf("arb_error now ");arb_printd(arb_err,20);printf("\n");
-      }
-      arb_mul_2exp_si(tmp,arb_err,L->target_prec+extra_bits);
-      arb_sub_ui(tmp,tmp,1,prec);
-      if(arb_is_negative(tmp)) // achieved target error
+      if(s_err_ok(sp->err,L,h,A,dimz,prec)) // achieved target error
         break;
       h*=1.01;
       H=ceil(A*A*h*h/2.0);
-      if(H*stride>L->u_no_values_off) // run out of data
+      if(H*SPEC_STRIDE>L->u_no_values_off) // run out of data
 	{
-	  arb_set(arb_err,best_err);
+	  arb_set(sp->err,best_err);
 	  h=best_h;H=best_H;
 	  //ecode|=ERR_SPEC_PREC; // not necessarily, wait till end
 	  break;
 	}
 
       M=H/A;
-      ecode|=arb_upsampling_error(arb_err,M,H,h,A,L->mus,L->degree,L->conductor,T,acb_imagref(z),0,L->pi,prec);
+      ecode|=arb_upsampling_error(sp->err,M,H,h,A,L->mus,L->degree,L->conductor,T,acb_imagref(z),0,L->pi,prec);
       if(fatal_error(ecode))
-      {
-        arb_clear(best_err);
-        arb_clear(tmp);
-        acb_clear(z);
-        acb_clear(an_s);
-        arb_clear(arb_err);
-        return ecode;
-      }
-      arb_sub(tmp,best_err,arb_err,prec);
+        break;
+      arb_sub(tmp,best_err,sp->err,prec);
       if(arb_is_positive(tmp)) // found a better h,H so use them
       {
         best_h=h;
         best_H=H;
-        arb_set(best_err,arb_err);
+        arb_set(best_err,sp->err);
       }
       if(verbose)
 	{
-	  printf("Upsampling error now ");arb_printd(arb_err,20);printf("\n");
+	  printf("Upsampling error now ");arb_printd(sp->err,20);printf("\n");
 	}
     }
     arb_clear(best_err);
+    arb_clear(tmp);
+    sp->h=h;
+    sp->H=H;
+    return ecode;
+  }
 
-    uint64_t iH=H;
-    if(verbose) printf("H = %" PRIu64 " h = %f\n",iH,h);
-    if(verbose) {printf("Upsample error set to ");arb_printd(arb_err,20);printf("\n");}
+  // compute L(s) into res by upsampling with the parameters in sp
+  Lerror_t s_evaluate(acb_t res, Lfunc *L, acb_t an_s, acb_t z, s_params_t *sp, int64_t prec)
+  {
+    if(verbose) printf("H = %" PRIu64 " h = %f\n",sp->H,sp->h);
+    if(verbose) {printf("Upsample error set to ");arb_printd(sp->err,20);printf("\n");}
 
-    arb_t pi_by_H2;
+    arb_t pi_by_H2,tmp;
     arb_init(pi_by_H2);
-    arb_set_d(tmp,h);
+    arb_init(tmp);
+    arb_set_d(tmp,sp->h);
     arb_mul(tmp,tmp,tmp,prec);
     arb_div(pi_by_H2,L->pi,tmp,prec);
     arb_neg(pi_by_H2,pi_by_H2); // -Pi/h^2
-    ecode|=s_upsample_stride(res, z, L, prec, pi_by_H2, arb_err, iH, stride);
+    Lerror_t ecode=s_upsample_stride(res, z, L, prec, pi_by_H2, sp->err, sp->H, SPEC_STRIDE);
     if(fatal_error(ecode))
     {
       arb_clear(pi_by_H2);
       arb_clear(tmp);
-      acb_clear(z);
-      acb_clear(an_s);
-      arb_clear(arb_err);
       return ecode;
     }
     if(verbose){printf("W(z) = ");acb_printd(res,20);printf("\n");}
@@ -373,12 +400,163 @@ extern "C"{
 
     acb_clear(s);
     acb_clear(ctmp);
-    acb_clear(z);
-    acb_clear(an_s);
     arb_clear(pi_by_H2);
     arb_clear(tmp);
-    arb_clear(arb_err);
+    return ecode;
+  }
+
+  // compute L(s) into res where s is given in algebraic normalisation
+  Lerror_t Lfunc_special_value(acb_t res, Lfunc_t LL, double alg_res, double alg_ims)
+  {
+    double T=alg_ims;
+    if (verbose) printf("T set to %f\n",T);
+    if(T<0.0)
+      return ERR_SPEC_NZ; // need s in upper half plane
+
+    Lfunc *L=(Lfunc *) LL;
+    int64_t prec=L->wprec;
+    //printf("Algebraic s = %f + i%f\n",alg_res,alg_ims);
+
+    acb_t an_s,z; // analytic version of s and where to upsample
+    acb_init(an_s);
+    acb_init(z);
+    s_setup(an_s,z,L,alg_res,alg_ims,prec);
+
+    s_params_t sp;
+    arb_init(sp.err);
+    double dimz=0.5-(alg_res - L->normalisation); // double approx to Im z
+    Lerror_t ecode=s_choose_params(&sp,L,T,dimz,z,0.0,prec);
+    if(!fatal_error(ecode))
+      ecode|=s_evaluate(res,L,an_s,z,&sp,prec);
 
+    arb_clear(sp.err);
+    acb_clear(z);
+    acb_clear(an_s);
+    return ecode;
+  }
+
+  // a batch of special values. Points with the same real part form a
+  // group, taken in order of imaginary part, and each point first tries
+  // the h chosen for the point before it.
+  typedef struct{
+    double re,im;
+    uint64_t i; // where it came from in the caller's arrays
+  } s_point_t;
+
+  typedef struct{
+    Lfunc *L;
+    acb_ptr res;
+    Lerror_t *ecodes;
+    s_point_t *pts; // sorted by re then im
+    uint64_t *groups; // group g is pts[groups[g]..groups[g+1]-1]
+    s_params_t *sp; // indexed like pts
+    acb_ptr an_s,z; // ditto
+  } s_batch_t;
+
+  static int s_point_cmp(const void *a, const void *b)
+  {
+    const s_point_t *pa=(const s_point_t *) a,*pb=(const s_point_t *) b;
+    if(pa->re!=pb->re)
+      return pa->re<pb->re ? -1 : 1;
+    if(pa->im!=pb->im)
+      return pa->im<pb->im ? -1 : 1;
+    return pa->i<pb->i ? -1 : (pa->i>pb->i);
+  }
+
+  // choose the parameters for every point in group g
+  static void s_group_job(uint64_t g, uint64_t thread, void *arg)
+  {
+    s_batch_t *sb=(s_batch_t *) arg;
+    Lfunc *L=sb->L;
+    (void) thread;
+    int64_t prec=L->wprec;
+    double try_h=0.0;
+    for(uint64_t j=sb->groups[g];j<sb->groups[g+1];j++)
+    {
+      s_point_t *pt=sb->pts+j;
+      if(pt->im<0.0)
+      {
+        sb->ecodes[pt->i]=ERR_SPEC_NZ; // need s in upper half plane
+        continue;
+      }
+      s_setup(sb->an_s+j,sb->z+j,L,pt->re,pt->im,prec);
+      if((j>sb->groups[g])&&(pt->im==pt[-1].im)&&(try_h>0.0)) // repeated point
+      {
+        sb->sp[j].h=sb->sp[j-1].h;
+        sb->sp[j].H=sb->sp[j-1].H;
+        arb_set(sb->sp[j].err,sb->sp[j-1].err);
+        sb->ecodes[pt->i]=sb->ecodes[pt[-1].i];
+        continue;
+      }
+      double dimz=0.5-(pt->re - L->normalisation); // double approx to Im z
+      sb->ecodes[pt->i]=s_choose_params(sb->sp+j,L,pt->im,dimz,sb->z+j,try_h,prec);
+      try_h=fatal_error(sb->ecodes[pt->i]) ? 0.0 : sb->sp[j].h;
+    }
+  }
+
+  static void s_evaluate_job(uint64_t j, uint64_t thread, void *arg)
+  {
+    s_batch_t *sb=(s_batch_t *) arg;
+    (void) thread;
+    uint64_t i=sb->pts[j].i;
+    if(!fatal_error(sb->ecodes[i]))
+      sb->ecodes[i]|=s_evaluate(sb->res+i,sb->L,sb->an_s+j,sb->z+j,sb->sp+j,sb->L->wprec);
+  }
+
+  // compute L(re[i]+i*im[i]) into res+i for i=0..n-1 with the error
+  // code for each point in ecodes[i]. Returns the union of the ecodes.
+  Lerror_t Lfunc_special_values(acb_ptr res, Lfunc_t LL, const double *re, const double *im, uint64_t n, Lerror_t *ecodes)
+  {
+    Lfunc *L=(Lfunc *) LL;
+    if(n==0)
+      return ERR_SUCCESS;
+
+    s_batch_t sb;
+    sb.L=L;
+    sb.res=res;
+    sb.ecodes=ecodes;
+    sb.pts=(s_point_t *)malloc(sizeof(s_point_t)*n);
+    sb.groups=(uint64_t *)malloc(sizeof(uint64_t)*(n+1));
+    sb.sp=(s_params_t *)malloc(sizeof(s_params_t)*n);
+    if(!sb.pts||!sb.groups||!sb.sp)
+    {
+      free(sb.pts);
+      free(sb.groups);
+      free(sb.sp);
+      for(uint64_t i=0;i<n;i++)
+        ecodes[i]=ERR_OOM;
+      return ERR_OOM;
+    }
+    sb.an_s=_acb_vec_init(n);
+    sb.z=_acb_vec_init(n);
+    for(uint64_t i=0;i<n;i++)
+    {
+      sb.pts[i].re=re[i];
+      sb.pts[i].im=im[i];
+      sb.pts[i].i=i;
+      arb_init(sb.sp[i].err);
+    }
+    qsort(sb.pts,n,sizeof(s_point_t),s_point_cmp);
+    uint64_t n_groups=0;
+    for(uint64_t j=0;j<n;j++)
+      if((j==0)||(sb.pts[j].re!=sb.pts[j-1].re))
+        sb.groups[n_groups++]=j;
+    sb.groups[n_groups]=n;
+
+    parallel_for(n_groups,&L->threads,s_group_job,&sb);
+    parallel_for(n,&L->threads,s_evaluate_job,&sb);
+
+    Lerror_t ecode=ERR_SUCCESS;
+    for(uint64_t i=0;i<n;i++)
+    {
+      ecode|=ecodes[i];
+      arb_clear(sb.sp[i].err);
+    }
+    _acb_vec_clear(sb.an_s,n);
+    _acb_vec_clear(sb.z,n);
+    free(sb.pts);
+    free(sb.groups);
+    free(sb.sp);
     return ecode;
   }
 
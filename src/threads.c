@@ -0,0 +1,143 @@
+#define _GNU_SOURCE // for pthread_attr_setaffinity_np
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include "glfunc.h"
+#include "glfunc_internals.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+  // what Lfunc_init_advanced uses when Lparams_t doesn't say
+  static uint64_t default_n_threads=DEFAULT_N_THREADS;
+  static int64_t default_first_cpu=-1;
+
+  void Lfunc_set_threads(uint64_t n_threads, int pin_threads, uint64_t first_cpu)
+  {
+    default_n_threads=n_threads ? n_threads : DEFAULT_N_THREADS;
+    default_first_cpu=(pin_threads>0) ? (int64_t) first_cpu : -1;
+  }
+
+  void default_threads(Lthreads_t *th)
+  {
+    th->n_threads=default_n_threads;
+    th->first_cpu=default_first_cpu;
+  }
+
+  // ask for worker thread to run on the (first_cpu+thread)th (mod how
+  // many there are) of the CPUs the process may use. We go by the main
+  // thread's mask as the caller may itself be a pinned worker. returns
+  // false if we can't, and then the worker runs wherever it is put.
+  static bool pin_attr(pthread_attr_t *attr, int64_t first_cpu, uint64_t thread)
+  {
+#ifdef __linux__
+    cpu_set_t allowed;
+    if((first_cpu<0)||sched_getaffinity(getpid(),sizeof(cpu_set_t),&allowed))
+      return false;
+    int n_cpus=CPU_COUNT(&allowed);
+    if(n_cpus<1)
+      return false;
+    int want=(first_cpu+thread)%n_cpus,cpu;
+    for(cpu=0;cpu<CPU_SETSIZE;cpu++)
+      if(CPU_ISSET(cpu,&allowed)&&(want--==0))
+        break;
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu,&cpus);
+    return pthread_attr_setaffinity_np(attr,sizeof(cpu_set_t),&cpus)==0;
+#else
+    (void) attr;(void) first_cpu;(void) thread;
+    return false;
+#endif
+  }
+
+  // a shared counter from which threads pull the next job
+  typedef struct{
+    void (*job)(uint64_t j, uint64_t thread, void *arg);
+    void *arg;
+    uint64_t n_jobs;
+    uint64_t next_job;
+    pthread_mutex_t lock;
+  } job_queue_t;
+
+  typedef struct{
+    job_queue_t *q;
+    uint64_t thread;
+  } worker_t;
+
+  static void run_queue(job_queue_t *q, uint64_t thread)
+  {
+    while(true)
+    {
+      pthread_mutex_lock(&q->lock);
+      uint64_t j=q->next_job++;
+      pthread_mutex_unlock(&q->lock);
+      if(j>=q->n_jobs)
+        return;
+      q->job(j,thread,q->arg);
+    }
+  }
+
+  static void *worker(void *w)
+  {
+    worker_t *wk=(worker_t *) w;
+    run_queue(wk->q,wk->thread);
+    flint_cleanup(); // release this thread's cached constants
+    return NULL;
+  }
+
+  // call job(j,thread,arg) for j=0..n_jobs-1 using up to th->n_threads
+  // threads, the caller being thread 0. Workers are pinned if th says
+  // so. thread<n_threads identifies which thread is running the job so
+  // the caller can hand out private workspace. returns once every job
+  // has completed.
+  void parallel_for(uint64_t n_jobs, const Lthreads_t *th, void (*job)(uint64_t j, uint64_t thread, void *arg), void *arg)
+  {
+    uint64_t n_threads=th->n_threads;
+    if(n_threads>n_jobs)
+      n_threads=n_jobs;
+    if(n_threads<=1)
+    {
+      for(uint64_t j=0;j<n_jobs;j++)
+        job(j,0,arg);
+      return;
+    }
+
+    job_queue_t q;
+    q.job=job;
+    q.arg=arg;
+    q.n_jobs=n_jobs;
+    q.next_job=0;
+    pthread_mutex_init(&q.lock,NULL);
+
+    pthread_t *tids=(pthread_t *)malloc(sizeof(pthread_t)*n_threads);
+    worker_t *wks=(worker_t *)malloc(sizeof(worker_t)*n_threads);
+    uint64_t started=1;
+    if(tids&&wks)
+      for(;started<n_threads;started++)
+      {
+        wks[started].q=&q;
+        wks[started].thread=started;
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        bool pinned=pin_attr(&attr,th->first_cpu,started);
+        int err=pthread_create(tids+started,&attr,worker,wks+started);
+        pthread_attr_destroy(&attr);
+        if(err&&pinned) // e.g. that CPU was taken away, so run unpinned
+          err=pthread_create(tids+started,NULL,worker,wks+started);
+        if(err)
+          break; // carry on with the threads we have
+      }
+    run_queue(&q,0); // jobs not taken by a worker get done here
+    for(uint64_t t=1;t<started;t++)
+      pthread_join(tids[t],NULL);
+
+    free(tids);
+    free(wks);
+    pthread_mutex_destroy(&q.lock);
+  }
+
+#ifdef __cplusplus
+}
+#endif
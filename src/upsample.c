@@ -375,16 +375,11 @@ Lerror_t init_upsampling(Lfunc *L)
 
 int64_t left_n(arb_ptr diff, arb_ptr t0, arb_t A, uint64_t prec)
 {
-  static arb_t tmp,tmp1;
-  static fmpz_t fmpz_tmp;
-  static bool init=false;
-  if(!init)
-  {
-    init=true;
-    arb_init(tmp);
-    arb_init(tmp1);
-    fmpz_init(fmpz_tmp);
-  }
+  arb_t tmp,tmp1;
+  fmpz_t fmpz_tmp;
+  arb_init(tmp);
+  arb_init(tmp1);
+  fmpz_init(fmpz_tmp);
   arb_mul(tmp,t0,A,prec);
   arb_get_mid_arb(tmp1,tmp);
   arb_floor(tmp,tmp1,prec);
@@ -392,12 +387,18 @@ int64_t left_n(arb_ptr diff, arb_ptr t0, arb_t A, uint64_t prec)
   {
     //printf("t0 = ");arb_printd(t0,20);printf(" tmp = ");arb_printd(tmp,20);printf("\n");
     //printf("Error rounding to int in upsample routines.\n");
+    arb_clear(tmp);
+    arb_clear(tmp1);
+    fmpz_clear(fmpz_tmp);
     return(BAD_64);
   }
   int64_t res=fmpz_get_si(fmpz_tmp); // this is going to be 1st point in left tail
   arb_set_si(tmp,res);
   arb_div(tmp,tmp,A,prec);
   arb_sub(diff,tmp,t0,prec); // will be -ve n pts to left of t0
+  arb_clear(tmp);
+  arb_clear(tmp1);
+  fmpz_clear(fmpz_tmp);
   return(res);
 }
 
@@ -405,29 +406,20 @@ int64_t left_n(arb_ptr diff, arb_ptr t0, arb_t A, uint64_t prec)
 // on entry sin_x = sin(pi x)
 void sinc(arb_t res, arb_t x, arb_t sin_x, arb_t pi, uint64_t prec)
 {
-  static arb_t tmp1;
-  static bool init=false;
-  if(!init)
-  {
-    init=true;
-    arb_init(tmp1);
-  }
+  arb_t tmp1;
+  arb_init(tmp1);
   arb_mul(tmp1,x,pi,prec);
   arb_div(res,sin_x,tmp1,prec);
+  arb_clear(tmp1);
 }
 
 //
 void do_point(arb_ptr res, Lfunc *L, int64_t n, arb_t t, arb_t delta, arb_t sin_delta, arb_t A, uint64_t side, uint64_t prec)
 {
-  static arb_t tmp,tmp1,tmp2;
-  static bool init=false;
-  if(!init)
-  {
-    init=true;
-    arb_init(tmp);
-    arb_init(tmp1);
-    arb_init(tmp2);
-  }
+  arb_t tmp,tmp1,tmp2;
+  arb_init(tmp);
+  arb_init(tmp1);
+  arb_init(tmp2);
   arb_mul(tmp,delta,delta,prec);
   arb_mul(tmp1,tmp,L->u_pi_by_H2,prec);
   arb_mul_ui(tmp,L->pi,L->degree,prec);
@@ -439,78 +431,88 @@ void do_point(arb_ptr res, Lfunc *L, int64_t n, arb_t t, arb_t delta, arb_t sin_
   sinc(tmp,tmp2,sin_delta,L->pi,prec);
   arb_mul(tmp2,tmp1,tmp,prec);
   arb_mul(res,tmp2,L->u_values[side][n],prec);
+  arb_clear(tmp);
+  arb_clear(tmp1);
+  arb_clear(tmp2);
 }
 
 // estimate f(t0) by upsampling off Lu->values
 bool upsample_stride(arb_ptr res, arb_ptr t0, Lfunc *L, uint64_t side, uint64_t prec)
 {
-  static arb_t step,diff,this_diff,term,A,t,t1,t_delta,sin_diff,neg_sin_diff;
-  static bool init=false;
-  if(!init)
-  {
-    init=true;
-    arb_init(step);
-    arb_init(t);
-    arb_init(t1);
-    arb_init(t_delta);
-    arb_init(A);
-    arb_init(diff);
-    arb_init(this_diff);
-    arb_init(term);
-    arb_init(sin_diff);
-    arb_init(neg_sin_diff);
-  }
+  arb_t step,diff,this_diff,term,A,t,t1,t_delta,sin_diff,neg_sin_diff;
+  arb_init(step);
+  arb_init(t);
+  arb_init(t1);
+  arb_init(t_delta);
+  arb_init(A);
+  arb_init(diff);
+  arb_init(this_diff);
+  arb_init(term);
+  arb_init(sin_diff);
+  arb_init(neg_sin_diff);
   arb_mul_ui(step,L->one_over_A,L->u_stride,prec);
   arb_div_ui(A,L->arb_A,L->u_stride,prec);
 
   int64_t n=left_n(diff,t0,L->arb_A,prec);
-  if(n==BAD_64)
-    return(false);
-  arb_mul(neg_sin_diff,diff,L->u_pi_A,prec);
-  arb_sin(sin_diff,neg_sin_diff,prec);
-  arb_neg(neg_sin_diff,sin_diff);
-  //printf("Nearest n = %" PRId64 "\n",n);
-  arb_mul_ui(t_delta,L->one_over_A,L->u_stride,prec);
-  arb_mul_si(t1,L->one_over_A,n,prec);
-  arb_set(t,t1);
-  int64_t nn=n+L->u_N*L->u_stride*2,nn1=nn; // offset into values
-
-  // do nearest point
-  do_point(res,L,nn,t,diff,sin_diff,A,side,prec);
-
-  arb_set(this_diff,diff);
-  // do Lu->N-1 points to left of left
-  for(uint64_t count=0;count<L->u_N-1;count++)
+  bool ok=(n!=BAD_64);
+  if(ok)
   {
-    arb_sub(this_diff,this_diff,step,prec);
-    arb_sub(t,t,t_delta,prec);
-    nn-=L->u_stride;
-    if(count&1)
-      do_point(term,L,nn,t,this_diff,sin_diff,A,side,prec);
-    else
-      do_point(term,L,nn,t,this_diff,neg_sin_diff,A,side,prec);
-
-    arb_add(res,res,term,prec);
-  }
+    arb_mul(neg_sin_diff,diff,L->u_pi_A,prec);
+    arb_sin(sin_diff,neg_sin_diff,prec);
+    arb_neg(neg_sin_diff,sin_diff);
+    //printf("Nearest n = %" PRId64 "\n",n);
+    arb_mul_ui(t_delta,L->one_over_A,L->u_stride,prec);
+    arb_mul_si(t1,L->one_over_A,n,prec);
+    arb_set(t,t1);
+    int64_t nn=n+L->u_N*L->u_stride*2,nn1=nn; // offset into values
+
+    // do nearest point
+    do_point(res,L,nn,t,diff,sin_diff,A,side,prec);
+
+    arb_set(this_diff,diff);
+    // do Lu->N-1 points to left of left
+    for(uint64_t count=0;count<L->u_N-1;count++)
+    {
+      arb_sub(this_diff,this_diff,step,prec);
+      arb_sub(t,t,t_delta,prec);
+      nn-=L->u_stride;
+      if(count&1)
+        do_point(term,L,nn,t,this_diff,sin_diff,A,side,prec);
+      else
+        do_point(term,L,nn,t,this_diff,neg_sin_diff,A,side,prec);
+
+      arb_add(res,res,term,prec);
+    }
 
-  arb_set(t,t1); // point to left again
-  arb_set(this_diff,diff);
-  nn=nn1;
+    arb_set(t,t1); // point to left again
+    arb_set(this_diff,diff);
+    nn=nn1;
 
-  // do N points to right of left
-  for(uint64_t count=0;count<L->u_N;count++)
-  {
-    arb_add(this_diff,this_diff,step,prec);
-    arb_add(t,t,t_delta,prec);
-    nn+=L->u_stride;
-    if(count&1)
-      do_point(term,L,nn,t,this_diff,sin_diff,A,side,prec);
-    else
-      do_point(term,L,nn,t,this_diff,neg_sin_diff,A,side,prec);
-    arb_add(res,res,term,prec);
+    // do N points to right of left
+    for(uint64_t count=0;count<L->u_N;count++)
+    {
+      arb_add(this_diff,this_diff,step,prec);
+      arb_add(t,t,t_delta,prec);
+      nn+=L->u_stride;
+      if(count&1)
+        do_point(term,L,nn,t,this_diff,sin_diff,A,side,prec);
+      else
+        do_point(term,L,nn,t,this_diff,neg_sin_diff,A,side,prec);
+      arb_add(res,res,term,prec);
+    }
+    arb_add_error(res,L->upsampling_error);
   }
-  arb_add_error(res,L->upsampling_error);
-  return(true);
+  arb_clear(step);
+  arb_clear(t);
+  arb_clear(t1);
+  arb_clear(t_delta);
+  arb_clear(A);
+  arb_clear(diff);
+  arb_clear(this_diff);
+  arb_clear(term);
+  arb_clear(sin_diff);
+  arb_clear(neg_sin_diff);
+  return(ok);
 }
 
 
@@ -518,110 +520,125 @@ bool upsample_stride(arb_ptr res, arb_ptr t0, Lfunc *L, uint64_t side, uint64_t
 // estimate f(t0) by upsampling off Lu->values
 bool new_upsample_stride(arb_ptr res, arb_ptr t0, Lfunc *L, uint64_t side, uint64_t prec)
 {
-  static arb_t step,diff,this_diff,term,A,t,t1,t_delta,sin_diff,neg_sin_diff,res_stack[STACK_SIZE];
-  static bool init=false;
-  if(!init)
-  {
-    init=true;
-    for(uint64_t i=0;i<STACK_SIZE;i++)
-      arb_init(res_stack[i]);
-    arb_init(step);
-    arb_init(t);
-    arb_init(t1);
-    arb_init(t_delta);
-    arb_init(A);
-    arb_init(diff);
-    arb_init(this_diff);
-    arb_init(term);
-    arb_init(sin_diff);
-    arb_init(neg_sin_diff);
-  }
+  arb_t step,diff,this_diff,term,A,t,t1,t_delta,sin_diff,neg_sin_diff,res_stack[STACK_SIZE];
+  for(uint64_t i=0;i<STACK_SIZE;i++)
+    arb_init(res_stack[i]);
+  arb_init(step);
+  arb_init(t);
+  arb_init(t1);
+  arb_init(t_delta);
+  arb_init(A);
+  arb_init(diff);
+  arb_init(this_diff);
+  arb_init(term);
+  arb_init(sin_diff);
+  arb_init(neg_sin_diff);
   arb_mul_ui(step,L->one_over_A,L->u_stride,prec);
   arb_div_ui(A,L->arb_A,L->u_stride,prec);
 
+  bool ok=true;
   int64_t n=left_n(diff,t0,L->arb_A,prec);
   if(n==BAD_64)
-    return false;
-  arb_mul(neg_sin_diff,diff,L->u_pi_A,prec);
-  arb_sin(sin_diff,neg_sin_diff,prec);
-  arb_neg(neg_sin_diff,sin_diff);
-  //printf("Nearest n = %" PRId64 "\n",n);
-  arb_mul_ui(t_delta,L->one_over_A,L->u_stride,prec);
-  arb_mul_si(t1,L->one_over_A,n,prec);
-  arb_set(t,t1);
-  int64_t nn=n+L->u_N*L->u_stride*2,nn1=nn; // offset into values
-
-  // do nearest point
-  do_point(res_stack[0],L,nn,t,diff,sin_diff,A,side,prec);
-  if(verbose){printf("upsample after first pt = ");arb_printd(res_stack[0],20);printf("\n");}
-
-  uint64_t res_ptr=1,res_count=1;
-
-  arb_set(this_diff,diff);
-  // do Lu->N-1 points to left of left
-  for(uint64_t count=0;count<L->u_N-1;count++)
+    ok=false;
+  else
   {
-    if(res_ptr>=STACK_SIZE)
-      return false;
-    arb_sub(this_diff,this_diff,step,prec);
-    arb_sub(t,t,t_delta,prec);
-    nn-=L->u_stride;
-    if(count&1)
-      do_point(res_stack[res_ptr++],L,nn,t,this_diff,sin_diff,A,side,prec);
-    else
-      do_point(res_stack[res_ptr++],L,nn,t,this_diff,neg_sin_diff,A,side,prec);
-    res_count++;
-    for(uint64_t i=res_count;!(i&1);i>>=1)
+    arb_mul(neg_sin_diff,diff,L->u_pi_A,prec);
+    arb_sin(sin_diff,neg_sin_diff,prec);
+    arb_neg(neg_sin_diff,sin_diff);
+    //printf("Nearest n = %" PRId64 "\n",n);
+    arb_mul_ui(t_delta,L->one_over_A,L->u_stride,prec);
+    arb_mul_si(t1,L->one_over_A,n,prec);
+    arb_set(t,t1);
+    int64_t nn=n+L->u_N*L->u_stride*2,nn1=nn; // offset into values
+
+    // do nearest point
+    do_point(res_stack[0],L,nn,t,diff,sin_diff,A,side,prec);
+    if(verbose){printf("upsample after first pt = ");arb_printd(res_stack[0],20);printf("\n");}
+
+    uint64_t res_ptr=1,res_count=1;
+
+    arb_set(this_diff,diff);
+    // do Lu->N-1 points to left of left
+    for(uint64_t count=0;ok&&(count<L->u_N-1);count++)
     {
-      arb_add(res_stack[res_ptr-2],res_stack[res_ptr-2],res_stack[res_ptr-1],prec);
-      res_ptr--;
+      if(res_ptr>=STACK_SIZE)
+      {
+        ok=false;
+        break;
+      }
+      arb_sub(this_diff,this_diff,step,prec);
+      arb_sub(t,t,t_delta,prec);
+      nn-=L->u_stride;
+      if(count&1)
+        do_point(res_stack[res_ptr++],L,nn,t,this_diff,sin_diff,A,side,prec);
+      else
+        do_point(res_stack[res_ptr++],L,nn,t,this_diff,neg_sin_diff,A,side,prec);
+      res_count++;
+      for(uint64_t i=res_count;!(i&1);i>>=1)
+      {
+        arb_add(res_stack[res_ptr-2],res_stack[res_ptr-2],res_stack[res_ptr-1],prec);
+        res_ptr--;
+      }
     }
-  }
 
-  arb_set(t,t1); // point to left again
-  arb_set(this_diff,diff);
-  nn=nn1;
-
-  // do N points to right of left
-  for(uint64_t count=0;count<L->u_N;count++) {
-    if(res_ptr>=STACK_SIZE)
-      return false;
-    arb_add(this_diff,this_diff,step,prec);
-    arb_add(t,t,t_delta,prec);
-    nn+=L->u_stride;
-    if(count&1)
-      do_point(res_stack[res_ptr++],L,nn,t,this_diff,sin_diff,A,side,prec);
-    else
-      do_point(res_stack[res_ptr++],L,nn,t,this_diff,neg_sin_diff,A,side,prec);
-    res_count++;
-    for(uint64_t i=res_count;!(i&1);i>>=1) {
-      arb_add(res_stack[res_ptr-2],res_stack[res_ptr-2],res_stack[res_ptr-1],prec);
-      res_ptr--;
+    arb_set(t,t1); // point to left again
+    arb_set(this_diff,diff);
+    nn=nn1;
+
+    // do N points to right of left
+    for(uint64_t count=0;ok&&(count<L->u_N);count++) {
+      if(res_ptr>=STACK_SIZE)
+      {
+        ok=false;
+        break;
+      }
+      arb_add(this_diff,this_diff,step,prec);
+      arb_add(t,t,t_delta,prec);
+      nn+=L->u_stride;
+      if(count&1)
+        do_point(res_stack[res_ptr++],L,nn,t,this_diff,sin_diff,A,side,prec);
+      else
+        do_point(res_stack[res_ptr++],L,nn,t,this_diff,neg_sin_diff,A,side,prec);
+      res_count++;
+      for(uint64_t i=res_count;!(i&1);i>>=1) {
+        arb_add(res_stack[res_ptr-2],res_stack[res_ptr-2],res_stack[res_ptr-1],prec);
+        res_ptr--;
+      }
+    }
+    if(ok)
+    {
+      arb_zero(res);
+      for(uint64_t i=0;i<res_ptr;i++)
+        arb_add(res,res,res_stack[i],prec);
+      arb_add_error(res,L->upsampling_error);
     }
   }
-  arb_zero(res);
-  for(uint64_t i=0;i<res_ptr;i++)
-    arb_add(res,res,res_stack[i],prec);
-  arb_add_error(res,L->upsampling_error);
-  return(true);
+  for(uint64_t i=0;i<STACK_SIZE;i++)
+    arb_clear(res_stack[i]);
+  arb_clear(step);
+  arb_clear(t);
+  arb_clear(t1);
+  arb_clear(t_delta);
+  arb_clear(A);
+  arb_clear(diff);
+  arb_clear(this_diff);
+  arb_clear(term);
+  arb_clear(sin_diff);
+  arb_clear(neg_sin_diff);
+  return(ok);
 }
 
 // delta=n/A-t
 // sin_delta=sin(Pi*A*(n/A-t))
 // compute differential at t
 void do_point_f_dash(arb_ptr res, Lfunc *L, int64_t n, arb_t t, arb_t delta, arb_t sin_delta, arb_t cos_delta, uint64_t side, uint64_t prec) {
-  static arb_t tmp,tmp1,tmp2,tmp3;
-  static arb_t A_pi_delta;
-  static bool init=false;
-  if(!init)
-  {
-    init=true;
-    arb_init(tmp);
-    arb_init(tmp1);
-    arb_init(tmp2);
-    arb_init(tmp3);
-    arb_init(A_pi_delta);
-  }
+  arb_t tmp,tmp1,tmp2,tmp3;
+  arb_t A_pi_delta;
+  arb_init(tmp);
+  arb_init(tmp1);
+  arb_init(tmp2);
+  arb_init(tmp3);
+  arb_init(A_pi_delta);
   //printf("In do_point_f_dash with t= ");arb_printd(t,20);printf("\n");
   //printf("In do_point_f_dash with delta= ");arb_printd(delta,20);printf("\n");
   arb_mul(A_pi_delta,delta,L->u_pi_A,prec);
@@ -639,41 +656,40 @@ void do_point_f_dash(arb_ptr res, Lfunc *L, int64_t n, arb_t t, arb_t delta, arb
   arb_mul(tmp2,tmp1,tmp,prec);
   arb_mul(res,tmp2,L->u_values[side][n],prec);
   //printf("do_point_f_dash returning ");arb_printd(res,20);printf("\n");
+  arb_clear(tmp);
+  arb_clear(tmp1);
+  arb_clear(tmp2);
+  arb_clear(tmp3);
+  arb_clear(A_pi_delta);
 }
 
 bool f_dash(arb_ptr res, arb_ptr t0, Lfunc *L, uint64_t side, uint64_t prec)
 {
-  static arb_t step,diff,this_diff,term,A,t,t1,t_delta;
-  //static arb_t t_error,diff_error;
-  static arb_t sin_diff,neg_sin_diff,cos_diff,neg_cos_diff;
-  static bool init=false;
-  if(!init)
+  arb_t step,diff,this_diff,term,A,t,t1,t_delta;
+  arb_t sin_diff,neg_sin_diff,cos_diff,neg_cos_diff;
+
+  arb_init(diff);
+  int64_t n=left_n(diff,t0,L->arb_A,prec);
+  if(n==BAD_64)
   {
-    init=true;
-    arb_init(step);
-    arb_init(t);
-    arb_init(t1);
-    arb_init(t_delta);
-    arb_init(A);
-    arb_init(diff);
-    arb_init(this_diff);
-    arb_init(sin_diff);
-    arb_init(neg_sin_diff);
-    arb_init(cos_diff);
-    arb_init(neg_cos_diff);
-    arb_init(term);
-    //arb_init(t_error);
-    //arb_init(diff_error);
-    //arb_mul_2exp_si(t_error,Lc->one_over_A,-1);
-    //arb_set_d(diff_error,Lu->stride*2);
-    //arb_inv(diff_error,diff_error,prec);
+    arb_clear(diff);
+    return(false);
   }
+
+  arb_init(step);
+  arb_init(t);
+  arb_init(t1);
+  arb_init(t_delta);
+  arb_init(A);
+  arb_init(this_diff);
+  arb_init(sin_diff);
+  arb_init(neg_sin_diff);
+  arb_init(cos_diff);
+  arb_init(neg_cos_diff);
+  arb_init(term);
   arb_mul_ui(step,L->one_over_A,L->u_stride,prec);
   arb_div_ui(A,L->arb_A,L->u_stride,prec);
 
-  int64_t n=left_n(diff,t0,L->arb_A,prec);
-  if(n==BAD_64)
-    return(false);
   //printf("Nearest n = %" PRId64 " diff = ",n);arb_printd(diff,10);printf("\n");
   arb_mul(neg_sin_diff,diff,L->arb_A,prec);
   arb_sin_cos_pi(sin_diff,cos_diff,neg_sin_diff,prec);
@@ -711,6 +727,18 @@ bool f_dash(arb_ptr res, arb_ptr t0, Lfunc *L, uint64_t side, uint64_t prec)
   }
   // nothing rigorous about N-R
   //arb_add_error(res,Lu->upsampling_error);
+  arb_clear(step);
+  arb_clear(t);
+  arb_clear(t1);
+  arb_clear(t_delta);
+  arb_clear(A);
+  arb_clear(diff);
+  arb_clear(this_diff);
+  arb_clear(sin_diff);
+  arb_clear(neg_sin_diff);
+  arb_clear(cos_diff);
+  arb_clear(neg_cos_diff);
+  arb_clear(term);
   return true;
 }
 
@@ -721,31 +749,38 @@ bool f_dash(arb_ptr res, arb_ptr t0, Lfunc *L, uint64_t side, uint64_t prec)
 // the zero found will be checked rigorously later
 bool newton(arb_ptr res, arb_ptr t0, Lfunc *L, uint64_t side, uint64_t prec)
 {
-  static bool init=false;
-  static arb_t f0,fd,t,tmp1;
-  if(!init)
-  {
-    init=true;
-    arb_init(f0);
-    arb_init(fd);
-    arb_init(t);
-    arb_init(tmp1);
-  }
+  bool ok=true;
+  arb_t f0,fd,t,tmp1;
+  arb_init(f0);
+  arb_init(fd);
+  arb_init(t);
+  arb_init(tmp1);
   arb_set(t,t0);
   for(uint64_t n=0;n<N_NEWTON_ITS;n++) {
     //printf("Newton t = ");arb_printd(t,60);printf("\n");
     if(!upsample_stride(f0,t,L,side,prec)) // f(t)
-      return false;
+    {
+      ok=false;
+      break;
+    }
     //printf("Newton f(t) = ");arb_printd(f0,60);printf("\n");
     if(!f_dash(fd,t,L,side,prec)) // f'(t)
-      return false;
+    {
+      ok=false;
+      break;
+    }
     //printf("Newton f'(t) = ");arb_printd(fd,60);printf("\n");
 
     arb_div(tmp1,f0,fd,prec);
     arb_sub(t,t,tmp1,prec); // t := t-f(t)/f'(t)
   }
-  arb_set(res,t);
-  return true;
+  if(ok)
+    arb_set(res,t);
+  arb_clear(f0);
+  arb_clear(fd);
+  arb_clear(t);
+  arb_clear(tmp1);
+  return ok;
 }
 
 #ifdef __cplusplus
@@ -29,19 +29,18 @@ sign_t sign(arb_t x) {
 
 // which way is the curve going?
 direction_t direction(arb_t a, arb_t b, uint64_t prec) {
-  static bool init = false;
-  static arb_t tmp;
-  if(!init)
-  {
-    init = true;
-    arb_init(tmp);
-  }
+  direction_t res;
+  arb_t tmp;
+  arb_init(tmp);
   arb_sub(tmp, a, b, prec);
   if(arb_contains_zero(tmp))
-    return UNK;
-  if(arb_is_negative(tmp)) // b>a
-    return UP;
-  return DOWN; // b<a
+    res = UNK;
+  else if(arb_is_negative(tmp)) // b>a
+    res = UP;
+  else
+    res = DOWN; // b<a
+  arb_clear(tmp);
+  return res;
 }
 
 // binary chop - isolate as far as we can
@@ -51,18 +50,14 @@ Lerror_t isolate_zero(
     arb_t ff0, arb_t ff1,
     int8_t s0, // sign of ff0
     Lfunc *L, uint64_t side, uint64_t prec) {
-  static bool init=false;
-  static arb_t tmp1, tmp2, tmp3, t0, t1, f0, f1;
-  if(!init) {
-    init=true;
-    arb_init(tmp1);
-    arb_init(tmp2);
-    arb_init(tmp3);
-    arb_init(t0);
-    arb_init(t1);
-    arb_init(f0);
-    arb_init(f1);
-  }
+  Lerror_t ecode=ERR_SUCCESS;
+  arb_t tmp1, tmp2, t0, t1, f0, f1;
+  arb_init(tmp1);
+  arb_init(tmp2);
+  arb_init(t0);
+  arb_init(t1);
+  arb_init(f0);
+  arb_init(f1);
   arb_set(t0, tt0);
   arb_set(t1, tt1);
   arb_set(f0, ff0);
@@ -71,12 +66,15 @@ Lerror_t isolate_zero(
     arb_add(tmp1, t0, t1, prec);
     arb_mul_2exp_si(tmp1, tmp1, -1);
     if(!upsample_stride(tmp2, tmp1, L, side, prec))
-      return ERR_UPSAMPLE;
+    {
+      ecode=ERR_UPSAMPLE;
+      break;
+    }
     sign_t new_sign=sign(tmp2);
     if(new_sign==UNK) // can't do any better
     {
       arb_union(res, t0, t1, prec);
-      return ERR_SUCCESS;
+      break;
     }
     if(new_sign!=s0) // change is between t0 and tmp1
     {
@@ -89,6 +87,13 @@ Lerror_t isolate_zero(
       arb_set(f0, tmp2);
     }
   }
+  arb_clear(tmp1);
+  arb_clear(tmp2);
+  arb_clear(t0);
+  arb_clear(t1);
+  arb_clear(f0);
+  arb_clear(f1);
+  return ecode;
 }
 
 
@@ -96,23 +101,18 @@ Lerror_t isolate_zero(
 // if !isolate_p, just confirm the two zeros to minimal precision
 Lerror_t stat_point(arb_t z1, arb_t z2, uint64_t m, Lfunc *L, uint64_t side, uint64_t prec, bool isolate_p) {
   Lerror_t ecode=ERR_SUCCESS;
-  static bool init=false;
-  static arb_t t0, t1, f0, f1, t2, f2, t01, f01, t12, f12, tmp;
-  if(!init)
-  {
-    init=true;
-    arb_init(t0);
-    arb_init(t1);
-    arb_init(t2);
-    arb_init(f0);
-    arb_init(f1);
-    arb_init(f2);
-    arb_init(t01);
-    arb_init(t12);
-    arb_init(f01);
-    arb_init(f12);
-    arb_init(tmp);
-  }
+  arb_t t0, t1, f0, f1, t2, f2, t01, f01, t12, f12, tmp;
+  arb_init(t0);
+  arb_init(t1);
+  arb_init(t2);
+  arb_init(f0);
+  arb_init(f1);
+  arb_init(f2);
+  arb_init(t01);
+  arb_init(t12);
+  arb_init(f01);
+  arb_init(f12);
+  arb_init(tmp);
 
   arb_mul_ui(t0, L->one_over_A, m-1, prec);
   arb_mul_ui(t1, L->one_over_A, m, prec);
@@ -139,32 +139,38 @@ Lerror_t stat_point(arb_t z1, arb_t z2, uint64_t m, Lfunc *L, uint64_t side, uin
     if(verbose){printf("fi = ");arb_printd(f0, 20);printf(" ");arb_printd(f1, 20);printf(" ");arb_printd(f2, 20);printf("\n");}
     arb_add(t01, t0, t1, prec);
     arb_mul_2exp_si(t01, t01, -1);
-    if(!upsample_stride(f01, t01, L, side, prec))
-      return ecode|ERR_STAT_POINT;
+    if(!upsample_stride(f01, t01, L, side, prec)) {
+      ecode|=ERR_STAT_POINT;
+      break;
+    }
     if(verbose){printf("t01 = ");arb_printd(t01, 20);printf("\n");}
     if(verbose){printf("f01 = ");arb_printd(f01, 20);printf("\n");}
     sign_t s01=sign(f01);
-    if(s01==UNK)
-      return ecode|ERR_DBL_ZERO;
+    if(s01==UNK) {
+      ecode|=ERR_DBL_ZERO;
+      break;
+    }
     if(s01!=s) {
       if(!isolate_p) {
         arb_union(z1, t0, t01, prec);
         arb_union(z2, t01, t1, prec);
-        return ecode;
+        break;
       }
       ecode|=isolate_zero(z1, t0, t01, f0, f01, s, L, side, prec);
       if(fatal_error(ecode))
-        return ecode;
+        break;
       ecode|=isolate_zero(z2, t01, t1, f01, f1, s01, L, side, prec);
-      return ecode;
+      break;
     }
     direction_t left=direction(f0, f01, prec);
     direction_t right=direction(f01, f1, prec);
     if(verbose){printf("f0 = ");arb_printd(f0, 20);printf("\n");}
     if(verbose){printf("f01 = ");arb_printd(f01, 20);printf("\n");}
     if(verbose){printf("f1 = ");arb_printd(f1, 20);printf("\n");}
-    if((left==UNK)||(right==UNK))
-      return ecode|ERR_DBL_ZERO;
+    if((left==UNK)||(right==UNK)) {
+      ecode|=ERR_DBL_ZERO;
+      break;
+    }
     if(left!=right)
     {
       arb_set(t2, t1);
@@ -179,26 +185,30 @@ Lerror_t stat_point(arb_t z1, arb_t z2, uint64_t m, Lfunc *L, uint64_t side, uin
     upsample_stride(f12, t12, L, side, prec);
     //printf("right middle = ");arb_printd(f12, 20);printf("\n");
     sign_t s12=sign(f12);
-    if(s12==UNK)
-      return ecode|ERR_DBL_ZERO;
+    if(s12==UNK) {
+      ecode|=ERR_DBL_ZERO;
+      break;
+    }
     if(s12!=s)
     {
       if(!isolate_p)
       {
         arb_union(z1, t1, t12, prec);
         arb_union(z2, t12, t2, prec);
-        return ecode;
+        break;
       }
       ecode|=isolate_zero(z1, t1, t12, f1, f12, s, L, side, prec);
       if(fatal_error(ecode))
-        return ecode;
+        break;
       isolate_zero(z2, t12, t2, f12, f2, s12, L, side, prec);
-      return ecode;
+      break;
     }
     left=direction(f1, f12, prec);
     right=direction(f12, f2, prec);
-    if((left==UNK)||(right==UNK))
-      return ecode|ERR_DBL_ZERO;
+    if((left==UNK)||(right==UNK)) {
+      ecode|=ERR_DBL_ZERO;
+      break;
+    }
     if(left!=right)
     {
       arb_set(t0, t1);
@@ -216,29 +226,41 @@ Lerror_t stat_point(arb_t z1, arb_t z2, uint64_t m, Lfunc *L, uint64_t side, uin
       continue;
     }
   }
+  arb_clear(t0);
+  arb_clear(t1);
+  arb_clear(t2);
+  arb_clear(f0);
+  arb_clear(f1);
+  arb_clear(f2);
+  arb_clear(t01);
+  arb_clear(t12);
+  arb_clear(f01);
+  arb_clear(f12);
+  arb_clear(tmp);
   return ecode;
 }
 
-// find some zeros
+// a sign change or stationary point found by scan_zeros, waiting to be isolated
+typedef struct{
+  uint64_t side;
+  uint64_t n; // between n-1 and n (sign change) or around n (stat point)
+  uint64_t slot; // where its zero(s) go in L->zeros[side]
+  bool stat; // is this a stationary point
+  bool isolate_p; // stationary point within the output region
+  sign_t last_sign; // sign at n-1
+  Lerror_t ecode;
+  arb_t z1,z2;
+} zero_bracket_t;
+
+// phase 1 of finding zeros: walk u_values_off[side] looking for sign
+// changes and stationary points, appending them to br. We stop where
+// the serial search would have, i.e. once MAX_ZEROS slots are spoken for.
 // errors:-
 //   two UNK at start of data ERR_NO_DATA
 //   direction unknown at start of data ERR_NO_DATA
 //   UNK anywhere but at start ERR_SOME_DATA
-Lerror_t find_zeros(Lfunc *L, uint64_t side)
+Lerror_t scan_zeros(zero_bracket_t *br, uint64_t *n_br, Lfunc *L, uint64_t side)
 {
-  static bool init=false;
-  static arb_t tmp, tmp1, tmp2, tmp3, t0, z1, z2;
-  if(!init)
-  {
-    init=true;
-    arb_init(tmp);
-    arb_init(tmp1);
-    arb_init(tmp2);
-    arb_init(tmp3);
-    arb_init(t0);
-    arb_init(z1);
-    arb_init(z2);
-  }
   int64_t prec = L->wprec;
   bool stat_points = true;
   for(uint64_t z = 0; z < MAX_ZEROS; z++)
@@ -248,33 +270,31 @@ Lerror_t find_zeros(Lfunc *L, uint64_t side)
   uint64_t n=0;
   sign_t last_sign, this_sign=sign(L->u_values_off[side][n]);
   direction_t this_dir, last_dir;
-  Lerror_t ecode=ERR_SUCCESS;
 
   if(this_sign == UNK) // central zero(s)
   {
     n++; // skip the central pt.
     this_sign=sign(L->u_values_off[side][n]);
     if(this_sign == UNK) // that was your last chance
-      return ecode|ERR_NO_DATA;
+      return ERR_NO_DATA;
   }
 
   this_dir=direction(L->u_values_off[side][n], L->u_values_off[side][n+1], prec);
   if(this_dir==UNK) {
     printf("Unknown direction at start of data.\n");
-    return ecode|ERR_NO_DATA;
+    return ERR_NO_DATA;
   }
 
-
   // now start searching for zeros and stat pts.
-  while(true) {
+  while(count<MAX_ZEROS) {
     n++;
     if(n > L->fft_NN/OUTPUT_RATIO+L->fft_NN/TURING_RATIO)
-      return ecode;
+      return ERR_SUCCESS;
     last_sign=this_sign;
     this_sign=sign(L->u_values_off[side][n]);
 
     if(this_sign==UNK) // run out of precision
-      return ecode|ERR_SOME_DATA;
+      return ERR_SOME_DATA;
 
     if(stat_points) {
       last_dir=this_dir;
@@ -283,19 +303,18 @@ Lerror_t find_zeros(Lfunc *L, uint64_t side)
         stat_points=false;
     }
 
-
+    zero_bracket_t *b=br+n_br[0];
+    b->side=side;
+    b->n=n;
+    b->slot=count;
+    b->last_sign=last_sign;
+    b->ecode=ERR_SUCCESS;
     if(this_sign!=last_sign) // found a zero between n and n-1
     {
-      arb_mul_ui(tmp1, L->one_over_A, n-1, prec);
-      arb_mul_ui(tmp2, L->one_over_A, n, prec);
-      if(verbose)
-      {
-        printf("zero found between ");arb_printd(tmp1, 20);
-        printf(" and ");arb_printd(tmp2, 20);printf("\n");
-      }
-      ecode|=isolate_zero(L->zeros[side][count++], tmp1, tmp2, L->u_values_off[side][n-1], L->u_values_off[side][n], last_sign, L, side, prec);
-      if(fatal_error(ecode)||(count==MAX_ZEROS))
-        return ecode;
+      if(verbose) printf("zero found between %" PRIu64 "/A and %" PRIu64 "/A\n",n-1,n);
+      b->stat=false;
+      n_br[0]++;
+      count++;
       continue;
     }
 
@@ -307,31 +326,140 @@ Lerror_t find_zeros(Lfunc *L, uint64_t side)
     if(this_dir!=last_dir) { // change in direction
       if(((last_dir==UP)&&(this_sign==NEG))||((last_dir==DOWN)&&(this_sign==POS))) {
         if(verbose) printf("Stationary point detected.\n");
-        ecode|=stat_point(z1, z2, n-1, L, side, prec, n<=L->fft_NN/OUTPUT_RATIO);
-        if(fatal_error(ecode))
-          return ecode;
-        if(verbose)
-        {
-          printf("Stat zero found at ");arb_printd(z1, 20);
-          printf("\nand                ");arb_printd(z2, 20);
-          printf("\n");fflush(stdout);
-        }
-        if(verbose){printf("setting zeros %" PRIu64 " and %" PRIu64 " to ", count, count+1);
-          arb_printd(z1, 20);printf(" ");arb_printd(z2, 20);printf("\n");}
-        arb_set(L->zeros[side][count], z1);
-        count++;
-        if(count==MAX_ZEROS)
-          return ecode;
-        arb_set(L->zeros[side][count], z2);
-        count++;
-        if(count==MAX_ZEROS)
-          return ecode;
+        b->stat=true;
+        b->isolate_p=(n<=L->fft_NN/OUTPUT_RATIO);
+        n_br[0]++;
+        count+=2;
       }
     }
   }
+  return ERR_SUCCESS;
+}
+
+typedef struct{
+  Lfunc *L;
+  zero_bracket_t *br;
+} isolate_job_t;
+
+// phase 2: isolate the zero(s) in bracket j
+void isolate_bracket(uint64_t j, uint64_t thread, void *arg)
+{
+  isolate_job_t *ij=(isolate_job_t *) arg;
+  Lfunc *L=ij->L;
+  zero_bracket_t *b=ij->br+j;
+  (void) thread;
+  int64_t prec = L->wprec;
+  if(b->stat)
+  {
+    b->ecode=stat_point(b->z1, b->z2, b->n-1, L, b->side, prec, b->isolate_p);
+    if(verbose)
+    {
+      printf("Stat zero found at ");arb_printd(b->z1, 20);
+      printf("\nand                ");arb_printd(b->z2, 20);
+      printf("\n");fflush(stdout);
+    }
+    return;
+  }
+  arb_t t0,t1;
+  arb_init(t0);
+  arb_init(t1);
+  arb_mul_ui(t0, L->one_over_A, b->n-1, prec);
+  arb_mul_ui(t1, L->one_over_A, b->n, prec);
+  b->ecode=isolate_zero(b->z1, t0, t1, L->u_values_off[b->side][b->n-1], L->u_values_off[b->side][b->n], b->last_sign, L, b->side, prec);
+  arb_clear(t0);
+  arb_clear(t1);
+}
+
+// copy the isolated zeros for one side into L->zeros[side], stopping
+// at the first fatal error just as a serial search would
+Lerror_t collect_zeros(zero_bracket_t *br, uint64_t n_br, Lerror_t scan_ecode, Lfunc *L)
+{
+  Lerror_t ecode=ERR_SUCCESS;
+  for(uint64_t j=0;j<n_br;j++)
+  {
+    zero_bracket_t *b=br+j;
+    ecode|=b->ecode;
+    if(!b->stat) // isolate_zero leaves what it found even if it fails
+      arb_set(L->zeros[b->side][b->slot], b->z1);
+    if(fatal_error(ecode))
+      return ecode;
+    if(b->stat)
+    {
+      if(verbose){printf("setting zeros %" PRIu64 " and %" PRIu64 " to ", b->slot, b->slot+1);
+        arb_printd(b->z1, 20);printf(" ");arb_printd(b->z2, 20);printf("\n");}
+      arb_set(L->zeros[b->side][b->slot], b->z1);
+      if(b->slot+1<MAX_ZEROS)
+        arb_set(L->zeros[b->side][b->slot+1], b->z2);
+    }
+  }
+  return ecode|scan_ecode;
+}
+
+// find the zeros on sides first_side..last_side
+// all the brackets are found first, then isolated in parallel
+Lerror_t find_zeros_sides(Lfunc *L, uint64_t first_side, uint64_t last_side)
+{
+  zero_bracket_t *br[2]={NULL,NULL};
+  uint64_t n_br[2]={0,0},total=0;
+  Lerror_t scan_ecode[2]={ERR_SUCCESS,ERR_SUCCESS};
+
+  zero_bracket_t *all=(zero_bracket_t *)malloc(sizeof(zero_bracket_t)*MAX_ZEROS*(last_side-first_side+1));
+  if(!all)
+    return ERR_OOM;
+  for(uint64_t side=first_side;side<=last_side;side++)
+  {
+    br[side]=all+total;
+    scan_ecode[side]=scan_zeros(br[side],n_br+side,L,side);
+    total+=n_br[side];
+  }
+
+  for(uint64_t j=0;j<total;j++)
+  {
+    arb_init(all[j].z1);
+    arb_init(all[j].z2);
+  }
+  isolate_job_t ij;
+  ij.L=L;
+  ij.br=all;
+  parallel_for(total,&L->threads,isolate_bracket,&ij);
+
+  Lerror_t ecode=ERR_SUCCESS;
+  for(uint64_t side=first_side;side<=last_side;side++)
+  {
+    if(fatal_error(scan_ecode[side]))
+      ecode|=scan_ecode[side];
+    else
+      ecode|=collect_zeros(br[side],n_br[side],scan_ecode[side],L);
+    if(fatal_error(ecode)) // the serial search would stop here
+    {
+      for(uint64_t s1=side+1;s1<=last_side;s1++)
+        for(uint64_t z = 0; z < MAX_ZEROS; z++)
+          arb_zero(L->zeros[s1][z]);
+      break;
+    }
+  }
+
+  for(uint64_t j=0;j<total;j++)
+  {
+    arb_clear(all[j].z1);
+    arb_clear(all[j].z2);
+  }
+  free(all);
   return ecode;
 }
 
+// find some zeros
+Lerror_t find_zeros(Lfunc *L, uint64_t side)
+{
+  return find_zeros_sides(L,side,side);
+}
+
+// find the zeros of L and, unless it is known to be self dual, of its dual
+Lerror_t find_all_zeros(Lfunc *L)
+{
+  return find_zeros_sides(L,0,(L->self_dual==YES) ? 0 : 1);
+}
+
 
 #ifdef __cplusplus
 }
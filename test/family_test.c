@@ -0,0 +1,157 @@
+/*
+   Two L-functions from one family, made and computed on two threads at
+   once, checked against the same two done on their own with Lfunc_init.
+   Both are products of an even and an odd quadratic character, so
+   degree 2 with mus [0,1] like dir_test.c, of conductors 5*7 and 5*3.
+*/
+
+#include <inttypes.h>
+#include <pthread.h>
+#include "acb_poly.h"
+#include "glfunc.h"
+
+typedef struct{
+  uint64_t q1,q2; // the two prime moduli
+  Lfunc_t L;
+  Lerror_t ecode;
+  Lfamily_t F;
+} job_t;
+
+// the quadratic character mod prime q at p
+int64_t legendre(uint64_t p, uint64_t q)
+{
+  uint64_t r=1,a=p%q;
+  if(a==0)
+    return 0;
+  for(uint64_t e=(q-1)/2;e;e>>=1,a=a*a%q)
+    if(e&1)
+      r=r*a%q;
+  return (r==1) ? 1 : -1;
+}
+
+// (1-chi_q1(p)T)(1-chi_q2(p)T)
+void lpoly_callback(acb_poly_t poly, uint64_t p, int d __attribute__((unused)), int64_t prec, void *param)
+{
+  job_t *j=(job_t *) param;
+  // pretend we run out of polynomials at p>100
+  if(p>100) {
+    acb_poly_zero(poly);
+    return;
+  }
+  acb_poly_t p1,p2;
+  acb_poly_init(p1);
+  acb_poly_one(p1);
+  acb_poly_set_coeff_si(p1,1,-legendre(p,j->q1));
+  acb_poly_init(p2);
+  acb_poly_one(p2);
+  acb_poly_set_coeff_si(p2,1,-legendre(p,j->q2));
+  acb_poly_mul(poly,p1,p2,prec);
+  acb_poly_clear(p1);
+  acb_poly_clear(p2);
+}
+
+void compute(job_t *j)
+{
+  if(fatal_error(j->ecode))
+    return;
+  j->ecode|=Lfunc_use_all_lpolys(j->L,lpoly_callback,j);
+  if(!fatal_error(j->ecode))
+    j->ecode|=Lfunc_compute(j->L);
+}
+
+void *from_family(void *arg)
+{
+  job_t *j=(job_t *) arg;
+  j->L=Lfunc_init_from_family(j->F,j->q1*j->q2,DK,DK,&j->ecode);
+  compute(j);
+  return NULL;
+}
+
+int compare(job_t *a, job_t *b)
+{
+  int failed=0;
+  if(!acb_overlaps(Lfunc_epsilon(a->L),Lfunc_epsilon(b->L)))
+  {
+    printf("Epsilons differ for conductor %" PRIu64 "\n",a->q1*a->q2);
+    failed=1;
+  }
+  for(uint64_t side=0;side<2;side++)
+  {
+    arb_srcptr z1=Lfunc_zeros(a->L,side),z2=Lfunc_zeros(b->L,side);
+    // each list ends at the first zero entry, or after MAX_ZEROS
+    for(uint64_t z=0;z<MAX_ZEROS;z++)
+    {
+      bool end1=arb_is_zero(z1+z),end2=arb_is_zero(z2+z);
+      if(end1&&end2)
+        break;
+      if(end1!=end2)
+      {
+        printf("Only one found zero %" PRIu64 " on side %" PRIu64 " for conductor %" PRIu64 "\n",z,side,a->q1*a->q2);
+        failed=1;
+        break;
+      }
+      if(!arb_overlaps(z1+z,z2+z))
+      {
+        printf("Zero %" PRIu64 " on side %" PRIu64 " differs for conductor %" PRIu64 " ",z,side,a->q1*a->q2);
+        arb_printd(z1+z,20);printf(" ");arb_printd(z2+z,20);printf("\n");
+        failed=1;
+      }
+    }
+  }
+  return failed;
+}
+
+int main (int argc, char**argv)
+{
+  printf("Command Line:- %s",argv[0]);
+  for(int i=1;i<argc;i++)
+    printf(" %s",argv[i]);
+  printf("\n");
+
+  double mus[]={0,1};
+  Lerror_t ecode=ERR_SUCCESS;
+  Lfamily_t F=Lfamily_init(2,0.0,mus,&ecode);
+  if(fatal_error(ecode))
+  {
+    fprint_errors(stderr,ecode);
+    return 1;
+  }
+
+  job_t fam[2]={{5,7,NULL,ERR_SUCCESS,F},{5,3,NULL,ERR_SUCCESS,F}};
+  job_t own[2]={{5,7,NULL,ERR_SUCCESS,NULL},{5,3,NULL,ERR_SUCCESS,NULL}};
+  pthread_t tid;
+  bool threaded=(pthread_create(&tid,NULL,from_family,fam+1)==0);
+  from_family(fam);
+  if(threaded)
+    pthread_join(tid,NULL);
+  else
+    from_family(fam+1);
+
+  int failed=0;
+  for(uint64_t i=0;i<2;i++)
+  {
+    own[i].L=Lfunc_init(2,own[i].q1*own[i].q2,0.0,mus,&own[i].ecode);
+    compute(own+i);
+    if(fatal_error(fam[i].ecode)||fatal_error(own[i].ecode))
+    {
+      fprint_errors(stderr,fam[i].ecode|own[i].ecode);
+      failed=1;
+      continue;
+    }
+    printf("Conductor %" PRIu64 " rank %" PRId64 " epsilon ",own[i].q1*own[i].q2,Lfunc_rank(fam[i].L));
+    acb_printd(Lfunc_epsilon(fam[i].L),20);printf("\n");
+    failed|=compare(fam+i,own+i);
+  }
+
+  for(uint64_t i=0;i<2;i++)
+  {
+    if(fam[i].L)
+      Lfunc_clear(fam[i].L);
+    if(own[i].L)
+      Lfunc_clear(own[i].L);
+  }
+  Lfamily_clear(F);
+
+  printf(failed ? "FAILED\n" : "Passed\n");
+  return failed;
+}
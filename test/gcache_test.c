@@ -0,0 +1,188 @@
+/*
+   Round trip through the binary G cache. Lfunc_fill_gcache writes the
+   table to an empty directory, then an Lfunc is made that maps it from
+   there and another that computes G with no cache at all. The two
+   should agree on epsilon and the zeros.
+   Uses the same L-function as dir_test.c.
+*/
+
+#include <dirent.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "acb_poly.h"
+#include "glfunc.h"
+
+// compute the Euler poly for p
+// with L the product of non-principal characters mod 5 and 7
+void lpoly_callback(acb_poly_t poly, uint64_t p, int d __attribute__((unused)), int64_t prec, void *param __attribute__((unused)))
+{
+  // pretend we run out of polynomials at p>100
+  if(p>100) {
+    acb_poly_zero(poly);
+    return;
+  }
+  acb_poly_t p5;
+  acb_poly_init(p5);
+  acb_poly_one(p5);
+  if((p%5==1)||(p%5==4))
+    acb_poly_set_coeff_si(p5,1,-1);
+  if((p%5==2)||(p%5==3))
+    acb_poly_set_coeff_si(p5,1,1);
+  acb_poly_t p7;
+  acb_poly_init(p7);
+  acb_poly_one(p7);
+  if((p%7==1)||(p%7==2)||(p%7==4))
+    acb_poly_set_coeff_si(p7,1,-1);
+  if((p%7==3)||(p%7==5)||(p%7==6))
+    acb_poly_set_coeff_si(p7,1,1);
+  acb_poly_mul(poly,p5,p7,prec);
+  acb_poly_clear(p5);
+  acb_poly_clear(p7);
+}
+
+double mus[]={0,1};
+
+void set_params(Lparams_t *Lp, char *cache_dir)
+{
+  Lparams_init(Lp);
+  Lp->degree=2;
+  Lp->conductor=5*7;
+  Lp->mus=mus;
+  Lp->cache_dir=cache_dir;
+}
+
+Lfunc_t make_L(char *cache_dir, Lerror_t *ecode)
+{
+  Lparams_t Lp;
+  set_params(&Lp,cache_dir);
+  Lfunc_t L=Lfunc_init_advanced(&Lp,ecode);
+  if(fatal_error(*ecode))
+    return NULL;
+  *ecode|=Lfunc_use_all_lpolys(L,lpoly_callback,NULL);
+  if(fatal_error(*ecode))
+    return NULL;
+  *ecode|=Lfunc_compute(L);
+  if(fatal_error(*ecode))
+    return NULL;
+  return L;
+}
+
+// how many .bin files in dir, removing everything if clean
+uint64_t cache_files(char *dir, bool clean)
+{
+  uint64_t n=0;
+  char fname[1024];
+  DIR *d=opendir(dir);
+  if(!d)
+    return 0;
+  struct dirent *e;
+  while((e=readdir(d)))
+  {
+    size_t len=strlen(e->d_name);
+    if((len>4)&&!strcmp(e->d_name+len-4,".bin"))
+      n++;
+    if(clean&&(e->d_name[0]!='.'))
+    {
+      snprintf(fname,sizeof(fname),"%s/%s",dir,e->d_name);
+      unlink(fname);
+    }
+  }
+  closedir(d);
+  if(clean)
+    rmdir(dir);
+  return n;
+}
+
+int main (int argc, char**argv)
+{
+  printf("Command Line:- %s",argv[0]);
+  for(int i=1;i<argc;i++)
+    printf(" %s",argv[i]);
+  printf("\n");
+
+  char dir[]="/tmp/gcache_testXXXXXX";
+  if(!mkdtemp(dir))
+  {
+    printf("Couldn't make a cache directory.\n");
+    return 1;
+  }
+  int failed=0;
+
+  // write
+  Lparams_t Lp;
+  set_params(&Lp,dir);
+  Lerror_t ecode=Lfunc_fill_gcache(&Lp);
+  if(ecode!=ERR_SUCCESS)
+  {
+    printf("Lfunc_fill_gcache failed.\n");
+    fprint_errors(stdout,ecode);
+    failed=1;
+  }
+  if(cache_files(dir,false)!=1)
+  {
+    printf("Expected one cache file in %s.\n",dir);
+    failed=1;
+  }
+  // a second fill should find it there
+  ecode=Lfunc_fill_gcache(&Lp);
+  if(ecode!=ERR_SUCCESS)
+  {
+    printf("Second Lfunc_fill_gcache failed.\n");
+    fprint_errors(stdout,ecode);
+    failed=1;
+  }
+
+  // map and read it back, and compare with no cache
+  Lerror_t ecode1=ERR_SUCCESS,ecode2=ERR_SUCCESS;
+  Lfunc_t L1=make_L(dir,&ecode1);
+  Lfunc_t L2=make_L(NULL,&ecode2);
+  if((!L1)||(!L2))
+  {
+    fprint_errors(stdout,ecode1|ecode2);
+    cache_files(dir,true);
+    return 1;
+  }
+  if(ecode1&ERR_G_OUTFILE)
+  {
+    printf("Using the cache tried to write it again.\n");
+    failed=1;
+  }
+  if(!acb_overlaps(Lfunc_epsilon(L1),Lfunc_epsilon(L2)))
+  {
+    printf("Epsilons differ ");acb_printd(Lfunc_epsilon(L1),20);
+    printf(" ");acb_printd(Lfunc_epsilon(L2),20);printf("\n");
+    failed=1;
+  }
+  for(uint64_t side=0;side<2;side++)
+  {
+    arb_srcptr z1=Lfunc_zeros(L1,side),z2=Lfunc_zeros(L2,side);
+    // each list ends at the first zero entry, or after MAX_ZEROS
+    for(uint64_t z=0;z<MAX_ZEROS;z++)
+    {
+      bool end1=arb_is_zero(z1+z),end2=arb_is_zero(z2+z);
+      if(end1&&end2)
+        break;
+      if(end1!=end2)
+      {
+        printf("Only one found zero %" PRIu64 " on side %" PRIu64 "\n",z,side);
+        failed=1;
+        break;
+      }
+      if(!arb_overlaps(z1+z,z2+z))
+      {
+        printf("Zero %" PRIu64 " on side %" PRIu64 " differs ",z,side);
+        arb_printd(z1+z,20);printf(" ");arb_printd(z2+z,20);printf("\n");
+        failed=1;
+      }
+    }
+  }
+
+  Lfunc_clear(L1);
+  Lfunc_clear(L2);
+  cache_files(dir,true);
+
+  printf(failed ? "FAILED\n" : "Passed\n");
+  return failed;
+}
@@ -0,0 +1,151 @@
+/*
+   The shortcuts final_ifft takes against a plain acb_ifft of the whole
+   vector. The input is made the way do_pre_iFFT_errors leaves it:
+   Hermitian, with data in [0,m) and its conjugates in (nn-m,nn), and
+   only error balls in between. Checks
+     acb_ifft_hermitian, with and without double-double
+     dd_ifft on the full vector
+   each at a precision double-double covers and at one it doesn't.
+*/
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include "acb.h"
+#include "glfunc_internals.h"
+
+#define M (64) // fft_N
+#define NN (512) // fft_NN
+#define A (40) // outputs -A..A are wanted
+#define DD_BITS (100) // about what double-double can manage
+
+// fill x[0..NN-1] as above, the same every time
+void make_input(acb_t *x, int64_t prec)
+{
+  srand(1);
+  for(uint64_t j=0;j<NN;j++)
+    acb_zero(x[j]);
+  for(uint64_t j=0;j<M;j++)
+  {
+    arb_set_d(acb_realref(x[j]),(double) rand()/RAND_MAX-0.5);
+    if(j) // x[0] is its own conjugate
+      arb_set_d(acb_imagref(x[j]),(double) rand()/RAND_MAX-0.5);
+    arb_add_error_2exp_si(acb_realref(x[j]),-prec+10);
+    arb_add_error_2exp_si(acb_imagref(x[j]),-prec+10);
+  }
+  for(uint64_t j=M;j<=NN-M;j++)
+  {
+    arb_add_error_2exp_si(acb_realref(x[j]),-prec+5);
+    arb_add_error_2exp_si(acb_imagref(x[j]),-prec+5);
+  }
+  for(uint64_t j=1;j<M;j++)
+    acb_conj(x[NN-j],x[j]);
+}
+
+// do the real parts of x and y overlap at k=-a..a (mod NN)? and are
+// y's radii below 2^(-bits/2), so the shortcut hasn't thrown it all
+// away?
+int compare(const char *what, acb_t *x, acb_t *y, uint64_t a, int64_t prec, int64_t bits)
+{
+  int failed=0;
+  mag_t lim;
+  mag_init(lim);
+  mag_set_ui_2exp_si(lim,1,-bits/2);
+  for(uint64_t k=0;k<NN;k++)
+  {
+    if((k>a)&&(k<NN-a))
+      continue;
+    if(!arb_overlaps(acb_realref(x[k]),acb_realref(y[k])))
+    {
+      printf("%s at prec %" PRId64 " differs at k=%" PRIu64 " ",what,prec,k);
+      arb_printd(acb_realref(x[k]),20);printf(" ");
+      arb_printd(acb_realref(y[k]),20);printf("\n");
+      failed=1;
+    }
+    if(mag_cmp(arb_radref(acb_realref(y[k])),lim)>0)
+    {
+      printf("%s at prec %" PRId64 " lost too much at k=%" PRIu64 " ",what,prec,k);
+      arb_printd(acb_realref(y[k]),20);printf("\n");
+      failed=1;
+    }
+  }
+  mag_clear(lim);
+  return failed;
+}
+
+int main (int argc, char**argv)
+{
+  printf("Command Line:- %s",argv[0]);
+  for(int i=1;i<argc;i++)
+    printf(" %s",argv[i]);
+  printf("\n");
+
+  Lthreads_t th={2,-1};
+  int failed=0;
+  int64_t precs[]={80,200};
+  acb_t *full=(acb_t *)malloc(sizeof(acb_t)*NN);
+  acb_t *x=(acb_t *)malloc(sizeof(acb_t)*NN);
+  for(uint64_t j=0;j<NN;j++)
+  {
+    acb_init(full[j]);
+    acb_init(x[j]);
+  }
+
+  for(uint64_t i=0;i<sizeof(precs)/sizeof(int64_t);i++)
+  {
+    int64_t prec=precs[i];
+    int64_t dd_bits=(prec<DD_BITS) ? prec : DD_BITS;
+    acb_t *w=get_twiddles(M,prec);
+    acb_t *ww=get_twiddles(NN,prec);
+    if((!w)||(!ww))
+    {
+      printf("Couldn't make twiddles.\n");
+      return 1;
+    }
+
+    make_input(full,prec);
+    acb_ifft(full,NN,ww,prec,&th);
+
+    for(int dd=0;dd<2;dd++)
+    {
+      make_input(x,prec);
+      if(!acb_ifft_hermitian(x,M,NN,A,w,ww,prec,dd,&th))
+      {
+        printf("acb_ifft_hermitian failed.\n");
+        failed=1;
+        continue;
+      }
+      failed|=compare(dd ? "Hermitian dd" : "Hermitian",full,x,A,prec,dd ? dd_bits : prec);
+      // everything outside -A..A should be left at zero
+      for(uint64_t k=A+1;k<NN-A;k++)
+        if(!acb_is_zero(x[k]))
+        {
+          printf("Hermitian output %" PRIu64 " isn't zero.\n",k);
+          failed=1;
+          break;
+        }
+    }
+
+    make_input(x,prec);
+    if(!dd_ifft(x,NN,ww))
+    {
+      printf("dd_ifft failed.\n");
+      failed=1;
+    }
+    else
+      failed|=compare("dd_ifft",full,x,NN/2,prec,dd_bits);
+
+    release_twiddles(w);
+    release_twiddles(ww);
+  }
+
+  for(uint64_t j=0;j<NN;j++)
+  {
+    acb_clear(full[j]);
+    acb_clear(x[j]);
+  }
+  free(full);
+  free(x);
+
+  printf(failed ? "FAILED\n" : "Passed\n");
+  return failed;
+}
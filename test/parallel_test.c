@@ -0,0 +1,155 @@
+/*
+   Check the threaded and batched entry points against the serial ones,
+   using the same L-function as dir_test.c.
+   Lfunc_use_all_lpolys_parallel vs Lfunc_use_all_lpolys
+   Lfunc_special_values vs Lfunc_special_value
+*/
+
+#include <inttypes.h>
+#include "acb_poly.h"
+#include "glfunc.h"
+
+#define N_THREADS (4)
+
+// compute the Euler poly for p
+// with L the product of non-principal characters mod 5 and 7
+// uses nothing but its arguments so is thread safe
+void lpoly_callback(acb_poly_t poly, uint64_t p, int d __attribute__((unused)), int64_t prec, void *param __attribute__((unused)))
+{
+  // pretend we run out of polynomials at p>100
+  if(p>100) {
+    acb_poly_zero(poly);
+    return;
+  }
+  acb_poly_t p5;
+  acb_poly_init(p5);
+  acb_poly_one(p5);
+  if((p%5==1)||(p%5==4))
+    acb_poly_set_coeff_si(p5,1,-1);
+  if((p%5==2)||(p%5==3))
+    acb_poly_set_coeff_si(p5,1,1);
+  acb_poly_t p7;
+  acb_poly_init(p7);
+  acb_poly_one(p7);
+  if((p%7==1)||(p%7==2)||(p%7==4))
+    acb_poly_set_coeff_si(p7,1,-1);
+  if((p%7==3)||(p%7==5)||(p%7==6))
+    acb_poly_set_coeff_si(p7,1,1);
+  acb_poly_mul(poly,p5,p7,prec);
+  acb_poly_clear(p5);
+  acb_poly_clear(p7);
+}
+
+Lfunc_t make_L(uint64_t n_threads, bool parallel, Lerror_t *ecode)
+{
+  double mus[]={0,1};
+  Lparams_t Lp;
+  Lparams_init(&Lp);
+  Lp.degree=2;
+  Lp.conductor=5*7;
+  Lp.mus=mus;
+  Lp.n_threads=n_threads;
+
+  Lfunc_t L=Lfunc_init_advanced(&Lp,ecode);
+  if(fatal_error(*ecode))
+    return NULL;
+  if(parallel)
+    *ecode|=Lfunc_use_all_lpolys_parallel(L,lpoly_callback,NULL);
+  else
+    *ecode|=Lfunc_use_all_lpolys(L,lpoly_callback,NULL);
+  if(fatal_error(*ecode))
+    return NULL;
+  *ecode|=Lfunc_compute(L);
+  if(fatal_error(*ecode))
+    return NULL;
+  return L;
+}
+
+int main (int argc, char**argv)
+{
+  printf("Command Line:- %s",argv[0]);
+  for(int i=1;i<argc;i++)
+    printf(" %s",argv[i]);
+  printf("\n");
+
+  Lerror_t ecode=ERR_SUCCESS,ecode1=ERR_SUCCESS;
+  Lfunc_t L=make_L(1,false,&ecode);
+  Lfunc_t L1=make_L(N_THREADS,true,&ecode1);
+  if((!L)||(!L1))
+  {
+    fprint_errors(stderr,ecode|ecode1);
+    return 1;
+  }
+  int failed=0;
+
+  // the coefficients are identical so everything that follows should be
+  if(Lfunc_rank(L)!=Lfunc_rank(L1))
+  {
+    printf("Ranks differ %" PRId64 " %" PRId64 "\n",Lfunc_rank(L),Lfunc_rank(L1));
+    failed=1;
+  }
+  if(!acb_equal(Lfunc_epsilon(L),Lfunc_epsilon(L1)))
+  {
+    printf("Epsilons differ ");acb_printd(Lfunc_epsilon(L),20);
+    printf(" ");acb_printd(Lfunc_epsilon(L1),20);printf("\n");
+    failed=1;
+  }
+  for(uint64_t side=0;side<2;side++)
+  {
+    arb_srcptr zeros=Lfunc_zeros(L,side),zeros1=Lfunc_zeros(L1,side);
+    // each list ends at the first zero entry, or after MAX_ZEROS
+    for(uint64_t z=0;z<MAX_ZEROS;z++)
+    {
+      bool end=arb_is_zero(zeros+z),end1=arb_is_zero(zeros1+z);
+      if(end&&end1)
+        break;
+      if(end!=end1)
+      {
+        printf("Only one run found zero %" PRIu64 " on side %" PRIu64 "\n",z,side);
+        failed=1;
+        break;
+      }
+      if(!arb_overlaps(zeros+z,zeros1+z))
+      {
+        printf("Zero %" PRIu64 " on side %" PRIu64 " differs ",z,side);
+        arb_printd(zeros+z,20);printf(" ");arb_printd(zeros1+z,20);printf("\n");
+        failed=1;
+      }
+    }
+  }
+
+  // a batch of special values against one at a time
+  double re[]={1.0,1.0,1.0,0.5,0.5,0.0},im[]={0.0,1.0,2.5,3.0,14.0,0.0};
+  uint64_t n=sizeof(re)/sizeof(double);
+  acb_ptr vals=_acb_vec_init(n);
+  Lerror_t ecodes[sizeof(re)/sizeof(double)];
+  ecode|=Lfunc_special_values(vals,L1,re,im,n,ecodes);
+  acb_t ctmp;
+  acb_init(ctmp);
+  for(uint64_t i=0;i<n;i++)
+  {
+    Lerror_t ecode2=Lfunc_special_value(ctmp,L,re[i],im[i]);
+    if(fatal_error(ecode2)!=fatal_error(ecodes[i]))
+    {
+      printf("Only one way failed for L(%f+%fi)\n",re[i],im[i]);
+      failed=1;
+    }
+    if(fatal_error(ecode2))
+      continue;
+    printf("L(%f+%fi) = ",re[i],im[i]);acb_printd(vals+i,20);printf("\n");
+    if(!acb_overlaps(ctmp,vals+i))
+    {
+      printf("but one at a time gives ");acb_printd(ctmp,20);printf("\n");
+      failed=1;
+    }
+  }
+  acb_clear(ctmp);
+  _acb_vec_clear(vals,n);
+
+  Lfunc_clear(L);
+  Lfunc_clear(L1);
+
+  printf(failed ? "FAILED\n" : "Passed\n");
+  fprint_errors(stderr,ecode|ecode1);
+  return failed;
+}